@@ -8,6 +8,8 @@
 
 typedef void *OMMP_SYSTEM_PRT;
 typedef void *OMMP_QM_HELPER_PRT;
+typedef int32_t (*OMMP_EXT_BLOCK_GET)(void *, int32_t, double *);
+typedef void (*OMMP_EXT_BLOCK_PUT)(void *, int32_t, const double *);
 
 #ifdef __cplusplus
 extern "C"
@@ -18,6 +20,7 @@ extern "C"
     extern OMMP_SYSTEM_PRT ommp_init_xyz(const char *, const char *);
     extern void ommp_set_default_solver(OMMP_SYSTEM_PRT, int32_t);
     extern void ommp_set_default_matv(OMMP_SYSTEM_PRT, int32_t);
+    extern void ommp_set_ipd_guess(OMMP_SYSTEM_PRT, int32_t, int32_t);
     extern void ommp_save_mmp(OMMP_SYSTEM_PRT, const char *, int32_t);
     extern void ommp_set_frozen_atoms(OMMP_SYSTEM_PRT, int32_t, const int32_t *);
     extern void ommp_turn_pol_off(OMMP_SYSTEM_PRT, int32_t, const int32_t *);
@@ -28,6 +31,7 @@ extern "C"
     extern void ommp_set_verbose(int32_t);
     extern void ommp_set_outputfile(const char *);
     extern void ommp_close_outputfile(void);
+    extern void ommp_set_prm_cache_dir(const char *);
     extern void ommp_message(const char *, int32_t, const char *);
     extern void ommp_fatal(const char *);
     extern void ommp_time_pull(const char *);
@@ -39,10 +43,14 @@ extern "C"
     extern double ommp_get_fixedelec_energy(OMMP_SYSTEM_PRT);
     extern void ommp_set_external_field(OMMP_SYSTEM_PRT, const double *, int32_t, int32_t);
     extern void ommp_set_external_field_nomm(OMMP_SYSTEM_PRT, const double *, int32_t, int32_t);
+    extern void ommp_solve_multi_field(OMMP_SYSTEM_PRT, int32_t, const double *, double *, int32_t, int32_t);
 
     extern void ommp_potential_mmpol2ext(OMMP_SYSTEM_PRT, int32_t, const double *, double *);
     extern void ommp_potential_mm2ext(OMMP_SYSTEM_PRT, int32_t, const double *, double *);
     extern void ommp_potential_pol2ext(OMMP_SYSTEM_PRT, int32_t, const double *, double *);
+    extern void ommp_prepare_mmpol2ext(OMMP_SYSTEM_PRT);
+    extern void ommp_potential_mmpol2ext_block(OMMP_SYSTEM_PRT, int32_t, const double *, double *);
+    extern void ommp_potential_mmpol2ext_batched(OMMP_SYSTEM_PRT, int32_t, OMMP_EXT_BLOCK_GET, OMMP_EXT_BLOCK_PUT, void *);
     extern void ommp_field_mmpol2ext(OMMP_SYSTEM_PRT, int32_t, const double *, double *);
     extern void ommp_field_mm2ext(OMMP_SYSTEM_PRT, int32_t, const double *, double *);
     extern void ommp_field_pol2ext(OMMP_SYSTEM_PRT, int32_t, const double *, double *);
@@ -148,6 +156,8 @@ extern "C"
     extern void ommp_smartinput_cpstr(const char *, char *, char **);
     extern OMMP_SYSTEM_PRT ommp_system_from_qm_helper(OMMP_QM_HELPER_PRT, const char *);
     extern void ommp_set_vdw_cutoff(OMMP_SYSTEM_PRT, double);
+    extern void ommp_set_vdw_skin(OMMP_SYSTEM_PRT, double);
+    extern void ommp_set_pbc_box(OMMP_SYSTEM_PRT, const double *);
 
     extern void ommp_enable_fmm(OMMP_SYSTEM_PRT);
     extern void ommp_disable_fmm(OMMP_SYSTEM_PRT);
@@ -157,6 +167,9 @@ extern "C"
     extern void ommp_set_fmm_lmax(OMMP_SYSTEM_PRT, int32_t);
     extern void ommp_set_fmm_distance(OMMP_SYSTEM_PRT, double);
     extern void ommp_set_fmm_min_cell_size(OMMP_SYSTEM_PRT, double);
+    extern void ommp_set_fmm_skin(OMMP_SYSTEM_PRT, double);
+    extern void ommp_set_use_laplace(OMMP_SYSTEM_PRT, bool);
+    extern void ommp_set_laplace_check(OMMP_SYSTEM_PRT, bool);
 
 #ifdef __cplusplus
 }
@@ -12,16 +12,26 @@ std::map<std::string, int32_t> solvers{
     {"conjugate gradient", OMMP_SOLVER_CG},
     {"cg", OMMP_SOLVER_CG},
     {"inversion", OMMP_SOLVER_INVERSION},
-    {"diis", OMMP_SOLVER_DIIS}
+    {"diis", OMMP_SOLVER_DIIS},
+    {"mixed precision conjugate gradient", OMMP_SOLVER_CG_MIXED},
+    {"cg mixed", OMMP_SOLVER_CG_MIXED}
 };
 
 std::map<std::string, int32_t> matvs{
     {"none", OMMP_MATV_NONE},
     {"default", OMMP_MATV_DEFAULT},
     {"incore", OMMP_MATV_INCORE},
+    {"sparse", OMMP_MATV_SPARSE},
     {"direct", OMMP_MATV_DIRECT}
 };
 
+std::map<std::string, int32_t> ipd_guesses{
+    {"none", OMMP_IPD_GUESS_NONE},
+    {"default", OMMP_IPD_GUESS_DEFAULT},
+    {"aspc", OMMP_IPD_GUESS_ASPC},
+    {"polynomial", OMMP_IPD_GUESS_POLY}
+};
+
 std::map<std::string, int32_t> verbosity{
     {"none", OMMP_VERBOSE_NONE},
     {"low", OMMP_VERBOSE_LOW},
@@ -216,6 +226,28 @@ class OMMPSystem{
             ommp_set_frozen_atoms(handler, frozen.shape(0), frozen.data());
         }
 
+        void set_ipd_guess(std::string method = "aspc",
+                           int32_t nhist = OMMP_IPD_GUESS_DEFAULT_NHIST){
+            if(ipd_guesses.find(method) == ipd_guesses.end()){
+                throw py::value_error("Selected guess method is not available!");
+            }
+            if(nhist < 1 || nhist > OMMP_IPD_GUESS_MAX_NHIST){
+                throw py::value_error("nhist should be between 1 and " + 
+                                      std::to_string(OMMP_IPD_GUESS_MAX_NHIST));
+            }
+
+            ommp_set_ipd_guess(handler, ipd_guesses[method], nhist);
+        }
+
+        void set_pbc_box(py_cdarray cell){
+            if(cell.ndim() != 2 || 
+               cell.shape(0) != 3 || cell.shape(1) != 3){
+                throw py::value_error("cell should be shaped [3, 3]");
+            }
+
+            ommp_set_pbc_box(handler, cell.data());
+        }
+
         void turn_pol_off(py_ciarray nopol){
             if(nopol.ndim() != 1){
                 throw py::value_error("nopol should be shaped [:]");
@@ -504,6 +536,38 @@ class OMMPSystem{
             return ;
         }
         
+        py_cdarray solve_multi_field(py_cdarray fields,
+                                     std::string solver = "none",
+                                     std::string matv = "none"){
+            if(fields.ndim() != 3 || 
+               fields.shape(1) != get_pol_atoms() ||
+               fields.shape(2) != 3){
+                throw py::value_error("fields should be shaped [nrhs, pol_atoms, 3]");
+            }
+
+            if(solvers.find(solver) == solvers.end()){
+                throw py::value_error("Selected solver is not available!");
+            }
+            
+            if(matvs.find(matv) == matvs.end()){
+                throw py::value_error("Selected matrix-vector method is not available!");
+            }
+
+            int nrhs = fields.shape(0);
+            int npol = get_pol_atoms();
+            double *mem = new double[nrhs*npol*3];
+
+            ommp_solve_multi_field(handler, nrhs, fields.data(), mem,
+                                   solvers[solver], matvs[matv]);
+
+            py::buffer_info bufinfo(mem, sizeof(double),
+                                    py::format_descriptor<double>::format(),
+                                    3,
+                                    {nrhs, npol, 3},
+                                    {npol*3*sizeof(double), 3*sizeof(double), sizeof(double)});
+            return py_cdarray(bufinfo);
+        }
+        
         void update_coordinates(py_cdarray c){ 
             if(c.ndim() != 2 || 
                c.shape(0) != get_mm_atoms() ||
@@ -1317,6 +1381,10 @@ void set_outputfile(std::string of){
     ommp_set_outputfile(of.c_str());
 }
 
+void set_prm_cache_dir(std::string d){
+    ommp_set_prm_cache_dir(d.c_str());
+}
+
 void close_outputfile(void){
     ommp_close_outputfile();
 }
@@ -1354,11 +1422,13 @@ PYBIND11_MODULE(__pyopenmmpol, m){
     m.def("time_pull", &time_pull);
     m.def("set_outputfile", &set_outputfile);
     m.def("close_outputfile", &close_outputfile);
+    m.def("set_prm_cache_dir", &set_prm_cache_dir);
     m.def("message", &message);
     m.def("fatal", &fatal);
     m.def("smartinput", &smartinput, py::return_value_policy::copy);
     m.attr("available_solvers") = solvers;
     m.attr("available_matrix_vector") = matvs;
+    m.attr("available_ipd_guess") = ipd_guesses;
     m.attr("verbosity") = verbosity;
     m.attr("__version__") = OMMP_VERSION_STRING;
     py::class_<OMMPSystem, std::shared_ptr<OMMPSystem>>(m, "OMMPSystem", "System of OMMP library.")
@@ -1373,6 +1443,15 @@ PYBIND11_MODULE(__pyopenmmpol, m){
              &OMMPSystem::set_frozen_atoms, 
              "Set the atoms of the system that should be frozen (1-based list) that is unable to move.", 
              py::arg("frozen_list"))
+        .def("set_ipd_guess", 
+             &OMMPSystem::set_ipd_guess, 
+             "Extrapolate the guess for induced dipoles from the solutions at nhist previous geometries each time the coordinates are updated.", 
+             py::arg("method") = "aspc",
+             py::arg("nhist") = OMMP_IPD_GUESS_DEFAULT_NHIST)
+        .def("set_pbc_box", 
+             &OMMPSystem::set_pbc_box, 
+             "Set the periodic cell of the system (one cell vector per row, atomic units): VdW interactions use minimum image convention and electrostatics particle-mesh Ewald.", 
+             py::arg("cell"))
         .def("turn_pol_off", 
              &OMMPSystem::turn_pol_off, 
              "Turn off polarizabilities of atoms in nopol list.", 
@@ -1419,6 +1498,13 @@ PYBIND11_MODULE(__pyopenmmpol, m){
              py::arg("solver") = "none",
              py::arg("matv") = "none")
         
+        .def("solve_multi_field",
+             &OMMPSystem::solve_multi_field,
+             "Solve the linear system for several external fields at once (MM field is not included) and return the induced dipoles [nrhs, pol_atoms, 3].",
+             py::arg("fields"),
+             py::arg("solver") = "none",
+             py::arg("matv") = "none")
+        
         .def("get_bond_energy", &OMMPSystem::get_bond_energy, "Compute the energy of bond stretching")
         .def("get_angle_energy", &OMMPSystem::get_angle_energy, "Compute the energy of angle bending")
         .def("get_torsion_energy", &OMMPSystem::get_torsion_energy, "Compute the energy of dihedral torsion")
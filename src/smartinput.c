@@ -172,17 +172,16 @@ semversion str_to_semversion(char *strin){
     return v;
 }
 
-bool md5_file_check(const char* my_file, const char *md5_sum){
-    // This function verifies if the file at the address of my_file has 
-    // the md5 sum defined by md5_sum. Return false if the check fail.
-
-    unsigned char c[MD5_DIGEST_LENGTH];
+static bool md5_file_digest(const char* my_file, unsigned char *c){
+    // Compute the md5 digest of the file at the address of my_file and
+    // save it in c (MD5_DIGEST_LENGTH bytes). Return false if the file
+    // cannot be opened.
     FILE *fp = fopen(my_file, "rb");
     MD5_CTX mdContext;
 
     if(fp == NULL) return false;
 
-#define BUF_SIZE 1024
+#define BUF_SIZE 65536
     unsigned char buf[BUF_SIZE];
 
     MD5_Init(&mdContext);
@@ -190,14 +189,40 @@ bool md5_file_check(const char* my_file, const char *md5_sum){
         MD5_Update (&mdContext, buf, nrd);
     MD5_Final (c, &mdContext);
 #undef BUF_SIZE
+    fclose(fp);
+    return true;
+}
+
+bool md5_file_check(const char* my_file, const char *md5_sum){
+    // This function verifies if the file at the address of my_file has 
+    // the md5 sum defined by md5_sum. Return false if the check fail.
 
+    unsigned char c[MD5_DIGEST_LENGTH];
     unsigned int l;
+
+    if(!md5_file_digest(my_file, c)) return false;
     
     for(int i = 0; i < MD5_DIGEST_LENGTH; i++){
         sscanf(&(md5_sum[i*2]), "%2x", &l);
         if(l != c[i]) return false;
     }
-    fclose(fp);
+    return true;
+}
+
+bool md5_file_hex(const char* my_file, char *md5_sum){
+    // Write the md5 sum of the file at the address of my_file in md5_sum
+    // as a string of 2*MD5_DIGEST_LENGTH hexadecimal digits (not null
+    // terminated). It is used to identify force-field files in the cache
+    // of parsed parameters. Return false if the file cannot be read.
+
+    unsigned char c[MD5_DIGEST_LENGTH];
+
+    if(!md5_file_digest(my_file, c)) return false;
+
+    for(int i = 0; i < MD5_DIGEST_LENGTH; i++){
+        md5_sum[2*i] = "0123456789abcdef"[c[i] >> 4];
+        md5_sum[2*i+1] = "0123456789abcdef"[c[i] & 0xf];
+    }
     return true;
 }
 
@@ -614,21 +639,27 @@ void c_smartinput(const char *json_file, OMMP_SYSTEM_PRT *ommp_sys, OMMP_QM_HELP
     cJSON *cur = input_json->child;
     char *path, *xyz_path = NULL, *prm_path = NULL,
          *hdf5_path = NULL, *mmpol_path = NULL,
-         *output_path = NULL, mode;
+         *output_path = NULL, *prm_cache_path = NULL, mode;
     char *json_name=NULL, *json_description=NULL;
     int32_t req_verbosity = OMMP_VERBOSE_DEFAULT,
             req_solver = OMMP_SOLVER_DEFAULT,
-            req_matv = OMMP_MATV_DEFAULT;
+            req_matv = OMMP_MATV_DEFAULT,
+            req_ipd_guess = OMMP_IPD_GUESS_DEFAULT,
+            req_ipd_guess_nhist = OMMP_IPD_GUESS_DEFAULT_NHIST;
     
     int32_t *la_mm=NULL, *la_qm=NULL, *la_la=NULL, *la_ner=NULL;
     unsigned int nfrozen = 0, nla = 0, nremovepol=0;
     int32_t *frozenat=NULL, *removepolat=NULL;
     double *la_bl=NULL;
     double vdw_cutoff = OMMP_DEFAULT_NL_CUTOFF;
+    double vdw_skin = 0.0;
+    unsigned int npbc = 0;
+    double pbc_in[9], pbc_cell[9];
     *ommp_qmh = NULL;
     bool force_fmm = false, fmm_enabled = false;
     double fmm_min_cell_size=OMMP_FMM_MIN_CELLSIZE;
     double fmm_distance_thr=OMMP_FMM_FAR_THR;
+    double fmm_skin=0.0;
     int32_t fmm_maxl_pol=OMMP_FMM_DEFAULT_MAXL_POL, fmm_maxl=OMMP_FMM_DEFAULT_MAXL;
 
     while(cur != NULL){
@@ -712,6 +743,11 @@ void c_smartinput(const char *json_file, OMMP_SYSTEM_PRT *ommp_sys, OMMP_QM_HELP
                 ommp_fatal("verbosity should be one of the following values [none, low, high, debug]");
             }
         }
+        else if(strcmp(cur->string, "prm_cache_dir") == 0){
+            if(!cJSON_IsString(cur))
+                ommp_fatal("prm_cache_dir should be a string.");
+            prm_cache_path = cur->valuestring;
+        }
         else if(strcmp(cur->string, "name") == 0){
             json_name = cur->valuestring;
         }
@@ -727,8 +763,10 @@ void c_smartinput(const char *json_file, OMMP_SYSTEM_PRT *ommp_sys, OMMP_QM_HELP
                 req_solver = OMMP_SOLVER_INVERSION;
             else if(strcmp(cur->valuestring, "diis") == 0)
                 req_solver = OMMP_SOLVER_DIIS;
+            else if(strcmp(cur->valuestring, "mixed precision conjugate gradient") == 0 || strcmp(cur->valuestring, "cg mixed") == 0)
+                req_solver = OMMP_SOLVER_CG_MIXED;
             else{
-                sprintf(msg, "Unrecognized option \"%s\" for solver; Available solvers are default, conjugate gradient, cg, inversion, diis.", cur->valuestring);
+                sprintf(msg, "Unrecognized option \"%s\" for solver; Available solvers are default, conjugate gradient, cg, inversion, diis, mixed precision conjugate gradient, cg mixed.", cur->valuestring);
                 ommp_fatal(msg);
             }
         }
@@ -739,11 +777,32 @@ void c_smartinput(const char *json_file, OMMP_SYSTEM_PRT *ommp_sys, OMMP_QM_HELP
                 req_matv = OMMP_MATV_DIRECT;
             else if(strcmp(cur->valuestring, "incore") == 0)
                 req_matv = OMMP_MATV_INCORE;
+            else if(strcmp(cur->valuestring, "sparse") == 0)
+                req_matv = OMMP_MATV_SPARSE;
             else{
-                sprintf(msg, "Unrecognized option \"%s\" for matrix_vector; Available solvers are default, direct, incore.", cur->valuestring);
+                sprintf(msg, "Unrecognized option \"%s\" for matrix_vector; Available solvers are default, direct, incore, sparse.", cur->valuestring);
                 ommp_fatal(msg);
             }
         }
+        else if(strcmp(cur->string, "ipd_guess") == 0){
+            if(strcmp(cur->valuestring, "default") == 0)
+                req_ipd_guess = OMMP_IPD_GUESS_DEFAULT;
+            else if(strcmp(cur->valuestring, "none") == 0)
+                req_ipd_guess = OMMP_IPD_GUESS_NONE;
+            else if(strcmp(cur->valuestring, "aspc") == 0)
+                req_ipd_guess = OMMP_IPD_GUESS_ASPC;
+            else if(strcmp(cur->valuestring, "polynomial") == 0)
+                req_ipd_guess = OMMP_IPD_GUESS_POLY;
+            else{
+                sprintf(msg, "Unrecognized option \"%s\" for ipd_guess; Available methods are default, none, aspc, polynomial.", cur->valuestring);
+                ommp_fatal(msg);
+            }
+        }
+        else if(strcmp(cur->string, "ipd_guess_history") == 0){
+            if(!cJSON_IsNumber(cur))
+                ommp_fatal("ipd_guess_history should be an integer.");
+            req_ipd_guess_nhist = cur->valueint;
+        }
         else if(strcmp(cur->string, "frozen_atoms") == 0){
             if(!cJSON_IsArray(cur))
                 ommp_fatal("frozen_atoms should be an array of integers!");
@@ -789,6 +848,32 @@ void c_smartinput(const char *json_file, OMMP_SYSTEM_PRT *ommp_sys, OMMP_QM_HELP
                 ommp_fatal("Van der Walls cutoff should be a number.");
             vdw_cutoff = cur->valuedouble * OMMP_ANG2AU;
         }
+        else if(strcmp(cur->string, "vdw_skin") == 0){
+            if(!cJSON_IsNumber(cur))
+                ommp_fatal("Van der Walls neighbor list skin should be a number.");
+            vdw_skin = cur->valuedouble * OMMP_ANG2AU;
+        }
+        else if(strcmp(cur->string, "pbc_box") == 0){
+            // Either the three edges of an orthorhombic box or the three 
+            // cell vectors one after the other, in Angstrom
+            if(!cJSON_IsArray(cur))
+                ommp_fatal("pbc_box should be an array of 3 or 9 numbers.");
+            cJSON *_arr = cur->child;
+            for(npbc = 0; _arr != NULL; _arr = _arr->next){
+                if(!cJSON_IsNumber(_arr) || npbc >= 9)
+                    ommp_fatal("pbc_box should be an array of 3 or 9 numbers.");
+                pbc_in[npbc++] = _arr->valuedouble * OMMP_ANG2AU;
+            }
+            if(npbc == 3){
+                for(int i=0; i < 9; i++) pbc_cell[i] = 0.0;
+                for(int i=0; i < 3; i++) pbc_cell[i*3+i] = pbc_in[i];
+            }
+            else if(npbc == 9){
+                for(int i=0; i < 9; i++) pbc_cell[i] = pbc_in[i];
+            }
+            else
+                ommp_fatal("pbc_box should be an array of 3 or 9 numbers.");
+        }
         else if(strcmp(cur->string, "link_atoms") == 0){
             if(!cJSON_IsArray(cur))
                 ommp_fatal("link_atoms should be an array of structures!");
@@ -875,6 +960,11 @@ void c_smartinput(const char *json_file, OMMP_SYSTEM_PRT *ommp_sys, OMMP_QM_HELP
                 ommp_fatal("FMM threshold distance should be a positive number.");
             fmm_distance_thr = cur->valuedouble * OMMP_ANG2AU;
         }
+        else if(strcmp(cur->string, "fmm_skin") == 0){
+            if(!cJSON_IsNumber(cur) || cur->valuedouble < 0.0)
+                ommp_fatal("FMM skin should be a non-negative number.");
+            fmm_skin = cur->valuedouble * OMMP_ANG2AU;
+        }
         else{
             sprintf(msg, "Unrecognized JSON element \"%s\".", cur->string);
             ommp_fatal(msg);
@@ -888,6 +978,9 @@ void c_smartinput(const char *json_file, OMMP_SYSTEM_PRT *ommp_sys, OMMP_QM_HELP
     // Set output file
     if(output_path != NULL)
         ommp_set_outputfile(output_path);
+    // Set cache directory for parsed prm files
+    if(prm_cache_path != NULL)
+        ommp_set_prm_cache_dir(prm_cache_path);
 
     // Print information from JSON
     if(json_name != NULL){
@@ -940,7 +1033,10 @@ void c_smartinput(const char *json_file, OMMP_SYSTEM_PRT *ommp_sys, OMMP_QM_HELP
     ommp_set_default_solver(*ommp_sys, req_solver);
     // Set matv in ommp_sys
     ommp_set_default_matv(*ommp_sys, req_matv);
-    // Set cutoff for VdW
+    // Set extrapolation of induced dipoles guess in ommp_sys
+    ommp_set_ipd_guess(*ommp_sys, req_ipd_guess, req_ipd_guess_nhist);
+    // Set cutoff and Verlet list skin for VdW
+    ommp_set_vdw_skin(*ommp_sys, vdw_skin);
     ommp_set_vdw_cutoff(*ommp_sys, vdw_cutoff);
 
     // Handle QM part of the system
@@ -962,6 +1058,14 @@ void c_smartinput(const char *json_file, OMMP_SYSTEM_PRT *ommp_sys, OMMP_QM_HELP
         free(removepolat);
     }
 
+    // Periodic boundary conditions (this also switches FMM off)
+    if(npbc > 0){
+        if(force_fmm && fmm_enabled)
+            ommp_fatal("FMM cannot be used with periodic boundary conditions.");
+        ommp_message("Setting periodic cell", OMMP_VERBOSE_DEBUG, "SI");
+        ommp_set_pbc_box(*ommp_sys, pbc_cell);
+    }
+
     if(force_fmm){
         if(fmm_enabled)
             ommp_enable_fmm(*ommp_sys);
@@ -973,6 +1077,7 @@ void c_smartinput(const char *json_file, OMMP_SYSTEM_PRT *ommp_sys, OMMP_QM_HELP
       ommp_set_fmm_lmax(*ommp_sys, fmm_maxl);
       ommp_set_fmm_distance(*ommp_sys, fmm_distance_thr);
       ommp_set_fmm_min_cell_size(*ommp_sys, fmm_min_cell_size);
+      ommp_set_fmm_skin(*ommp_sys, fmm_skin);
     }
 
     // Handle link atoms
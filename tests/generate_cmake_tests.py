@@ -3,6 +3,17 @@ import os.path as path
 
 converted_to_hdf5 = {}
 
+# Test programs that check their own results, they only take the json file
+# and a tolerance (see each program for its meaning)
+self_checking = {"fmm-update": ("C", "fmm_update"),
+                 "mmpol2ext-batched": ("C", "mmpol2ext_batched"),
+                 "multi-field": ("C", "multi_field"),
+                 "prm-cache": ("C", "prm_cache"),
+                 "vdw-pbc": ("F03", "vdw_pbc"),
+                 "fmm-ext": ("F03", "fmm_ext"),
+                 "ipd-guess": ("F03", "ipd_guess"),
+                 "mmpol2ext-block": ("F03", "mmpol2ext_block")}
+
 def generate_test(jsonfile, program, ref, ef, fout, atol, rtol):
     atol_ene = 1e-6
     rtol_ene = 1e-6
@@ -227,6 +238,17 @@ def generate_test(jsonfile, program, ref, ef, fout, atol, rtol):
             file=fout)
         print("""set_tests_properties({:s}_comp_ana_ref_HDF5 PROPERTIES DEPENDS {:s}_HDF5)""".format(tname, tname_ana), file=fout)
         print("endif ()", file=fout)
+    elif program in self_checking:
+        if atol is None:
+            atol = atol_ene
+
+        lang, prog = self_checking[program]
+        tname = "{:s}_{:s}".format(basename, prog)
+        print("""add_test(NAME {:s}
+                          COMMAND bin/{:s}_test_SI_{:s}
+                          ${{CMAKE_SOURCE_DIR}}/tests/{:s}
+                          {:6.5g})""".format(tname, lang, prog, jsonfile, atol),
+              file=fout)
     else:
         print("message(FATAL_ERROR, \"Automatically generated test {:s} cannot be understood\")".format(program), file=fout)
 
@@ -0,0 +1,90 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "openmmpol.h"
+
+// FMM skin used for the incremental updates (Angstrom)
+#define TEST_FMM_SKIN 1.0
+// Number of displacement steps and maximum displacement per step along
+// each coordinate (Angstrom), the total displacement should stay well
+// below half of the skin.
+#define TEST_NSTEP 5
+#define TEST_DISP 0.02
+
+void displace(int n, int step, double *c){
+    for(int i=0; i < n; i++){
+        c[i*3+0] += TEST_DISP * OMMP_ANG2AU * sin(i + step);
+        c[i*3+1] += TEST_DISP * OMMP_ANG2AU * cos(2*i + step);
+        c[i*3+2] += TEST_DISP * OMMP_ANG2AU * sin(3*i + 2*step);
+    }
+}
+
+void energies(OMMP_SYSTEM_PRT s, double *em, double *ep){
+    int pol_atoms = ommp_get_pol_atoms(s);
+    double *ef = (double *) calloc(3 * pol_atoms, sizeof(double));
+
+    *em = ommp_get_fixedelec_energy(s);
+    ommp_set_external_field(s, ef, OMMP_SOLVER_NONE, OMMP_MATV_NONE);
+    *ep = ommp_get_polelec_energy(s);
+    free(ef);
+}
+
+int main(int argc, char **argv){
+    if(argc != 2 && argc != 3){
+        printf("Syntax expected\n");
+        printf("    $ test_SI_fmm_update.exe <JSON FILE> [<ABSOLUTE TOL>]\n");
+        return 1;
+    }
+
+    char msg[OMMP_STR_CHAR_MAX];
+    double atol = 1e-6, em_inc, ep_inc, em_full, ep_full;
+    OMMP_SYSTEM_PRT sys_inc, sys_full;
+    OMMP_QM_HELPER_PRT qmh;
+
+    if(argc == 3) atol = atof(argv[2]);
+
+    // System updated incrementally along a few small displacements
+    ommp_smartinput(argv[1], &sys_inc, &qmh);
+    if(!ommp_use_fmm(sys_inc)){
+        ommp_message("FMM are not enabled for this system", OMMP_VERBOSE_NONE, "TEST-FMM");
+        return 1;
+    }
+    ommp_set_fmm_skin(sys_inc, TEST_FMM_SKIN * OMMP_ANG2AU);
+
+    int mm_atoms = ommp_get_mm_atoms(sys_inc);
+    double *c = (double *) malloc(sizeof(double) * 3 * mm_atoms);
+    double *cmm = ommp_get_cmm(sys_inc);
+    for(int i=0; i < 3 * mm_atoms; i++)
+        c[i] = cmm[i];
+
+    for(int istep=0; istep < TEST_NSTEP; istep++){
+        displace(mm_atoms, istep, c);
+        ommp_update_coordinates(sys_inc, c);
+    }
+    energies(sys_inc, &em_inc, &ep_inc);
+
+    // Same system with the tree built from scratch on final coordinates
+    ommp_smartinput(argv[1], &sys_full, &qmh);
+    ommp_update_coordinates(sys_full, c);
+    // Setting the skin always forces a full rebuild
+    ommp_set_fmm_skin(sys_full, TEST_FMM_SKIN * OMMP_ANG2AU);
+    energies(sys_full, &em_full, &ep_full);
+
+    sprintf(msg, "EM incremental %20.12e full rebuild %20.12e", em_inc, em_full);
+    ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-FMM");
+    sprintf(msg, "EP incremental %20.12e full rebuild %20.12e", ep_inc, ep_full);
+    ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-FMM");
+
+    free(c);
+    ommp_terminate(sys_inc);
+    ommp_terminate(sys_full);
+
+    if(fabs(em_inc - em_full) > atol || fabs(ep_inc - ep_full) > atol){
+        sprintf(msg, "Incremental and full FMM update differ by more than %e", atol);
+        ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-FMM");
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,99 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "openmmpol.h"
+
+// Size of the blocks used for the batched calculation, well below
+// OMMP_FMM_EXT_THR, so that blocks would take the direct path if the
+// choice was based on the number of points.
+#define TEST_BLOCK_SIZE 97
+
+typedef struct {
+    int32_t n;
+    const double *c;
+    double *v;
+    int32_t next, last;
+} points_stream;
+
+int32_t get_block(void *ctx, int32_t block_size, double *c){
+    points_stream *ps = (points_stream *) ctx;
+    int32_t n = ps->n - ps->next;
+
+    if(n > block_size) n = block_size;
+    for(int i=0; i < 3 * n; i++)
+        c[i] = ps->c[3 * ps->next + i];
+    ps->last = ps->next;
+    ps->next += n;
+    return n;
+}
+
+void put_block(void *ctx, int32_t n, const double *v){
+    points_stream *ps = (points_stream *) ctx;
+
+    for(int i=0; i < n; i++)
+        ps->v[ps->last + i] = v[i];
+}
+
+int main(int argc, char **argv){
+    if(argc != 2 && argc != 3){
+        printf("Syntax expected\n");
+        printf("    $ test_SI_mmpol2ext_batched.exe <JSON FILE> [<ABSOLUTE TOL>]\n");
+        return 1;
+    }
+
+    char msg[OMMP_STR_CHAR_MAX];
+    double atol = 1e-8, maxdiff = 0.0;
+    OMMP_SYSTEM_PRT sys;
+    OMMP_QM_HELPER_PRT qmh;
+
+    if(argc == 3) atol = atof(argv[2]);
+
+    ommp_smartinput(argv[1], &sys, &qmh);
+
+    // Induced dipoles in absence of external field
+    int pol_atoms = ommp_get_pol_atoms(sys);
+    double *ef = (double *) calloc(3 * pol_atoms, sizeof(double));
+    ommp_set_external_field(sys, ef, OMMP_SOLVER_NONE, OMMP_MATV_NONE);
+    free(ef);
+
+    // Enough points to take the FMM path (when enabled) in a single call,
+    // placed around the MM atoms
+    int mm_atoms = ommp_get_mm_atoms(sys);
+    int32_t n = OMMP_FMM_EXT_THR + TEST_BLOCK_SIZE / 2;
+    double *cmm = ommp_get_cmm(sys);
+    double *c = (double *) malloc(sizeof(double) * 3 * n);
+    for(int i=0; i < n; i++){
+        int j = i % mm_atoms;
+        c[i*3+0] = cmm[j*3+0] + 2.0 * OMMP_ANG2AU * sin(i);
+        c[i*3+1] = cmm[j*3+1] + 2.0 * OMMP_ANG2AU * cos(2*i);
+        c[i*3+2] = cmm[j*3+2] + 2.0 * OMMP_ANG2AU * sin(3*i + 1);
+    }
+
+    double *vref = (double *) calloc(n, sizeof(double));
+    ommp_potential_mmpol2ext(sys, n, c, vref);
+
+    double *v = (double *) calloc(n, sizeof(double));
+    points_stream ps = {n, c, v, 0, 0};
+    ommp_potential_mmpol2ext_batched(sys, TEST_BLOCK_SIZE, get_block, put_block, &ps);
+
+    for(int i=0; i < n; i++)
+        if(fabs(v[i] - vref[i]) > maxdiff) maxdiff = fabs(v[i] - vref[i]);
+
+    sprintf(msg, "%d points (FMM %s), max deviation batched/full %e", n,
+            ommp_use_fmm(sys) ? "enabled" : "disabled", maxdiff);
+    ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-EXT");
+
+    free(c);
+    free(v);
+    free(vref);
+    ommp_terminate(sys);
+
+    if(ps.next != n || maxdiff > atol){
+        sprintf(msg, "Batched and full potential differ by more than %e", atol);
+        ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-EXT");
+        return 1;
+    }
+
+    return 0;
+}
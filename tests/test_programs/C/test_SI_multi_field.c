@@ -0,0 +1,105 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "openmmpol.h"
+
+// Number of fields solved at once: a zero field, a weak field (that
+// converges in fewer iterations than the others) and two regular fields
+#define TEST_NRHS 4
+
+typedef struct {
+    int32_t solver, matv;
+    const char *label;
+} solver_setup;
+
+static const solver_setup setups[] = {
+    {OMMP_SOLVER_CG, OMMP_MATV_INCORE, "CG incore"},
+    {OMMP_SOLVER_CG, OMMP_MATV_DIRECT, "CG direct"},
+    {OMMP_SOLVER_CG, OMMP_MATV_SPARSE, "CG sparse"},
+    {OMMP_SOLVER_DIIS, OMMP_MATV_DIRECT, "DIIS direct"},
+    {OMMP_SOLVER_INVERSION, OMMP_MATV_INCORE, "Inversion"}
+};
+
+void make_fields(int pol_atoms, double *ef){
+    for(int i=0; i < pol_atoms; i++){
+        double *e;
+
+        e = ef + 3 * i;
+        e[0] = e[1] = e[2] = 0.0;
+
+        e = ef + 3 * (pol_atoms + i);
+        e[0] = 1e-6 * sin(i);
+        e[1] = 1e-6 * cos(2*i);
+        e[2] = 1e-6 * sin(3*i + 1);
+
+        e = ef + 3 * (2 * pol_atoms + i);
+        e[0] = 1e-2 * sin(i);
+        e[1] = 1e-2 * cos(2*i);
+        e[2] = 1e-2 * sin(3*i + 1);
+
+        e = ef + 3 * (3 * pol_atoms + i);
+        e[0] = 0.0;
+        e[1] = 0.0;
+        e[2] = 5e-3;
+    }
+}
+
+int main(int argc, char **argv){
+    if(argc != 2 && argc != 3){
+        printf("Syntax expected\n");
+        printf("    $ test_SI_multi_field.exe <JSON FILE> [<ABSOLUTE TOL>]\n");
+        return 1;
+    }
+
+    char msg[OMMP_STR_CHAR_MAX];
+    double atol = 1e-6;
+    int failed = 0;
+    OMMP_SYSTEM_PRT sys;
+    OMMP_QM_HELPER_PRT qmh;
+
+    if(argc == 3) atol = atof(argv[2]);
+
+    ommp_smartinput(argv[1], &sys, &qmh);
+
+    int pol_atoms = ommp_get_pol_atoms(sys);
+    double *ef = (double *) malloc(sizeof(double) * 3 * pol_atoms * TEST_NRHS);
+    double *ipds = (double *) malloc(sizeof(double) * 3 * pol_atoms * TEST_NRHS);
+    make_fields(pol_atoms, ef);
+
+    for(size_t is=0; is < sizeof(setups) / sizeof(solver_setup); is++){
+        double maxdiff = 0.0;
+
+        ommp_solve_multi_field(sys, TEST_NRHS, ef, ipds,
+                               setups[is].solver, setups[is].matv);
+
+        for(int k=0; k < TEST_NRHS; k++){
+            // Reference: the same field solved on its own; for AMOEBA the
+            // first set of dipoles (D) is the same as P without MM field
+            ommp_set_external_field_nomm(sys, ef + 3 * pol_atoms * k,
+                                         setups[is].solver, setups[is].matv);
+            double *ipd = ommp_get_ipd(sys);
+            for(int i=0; i < 3 * pol_atoms; i++){
+                double d = fabs(ipds[3 * pol_atoms * k + i] - ipd[i]);
+                if(d > maxdiff) maxdiff = d;
+            }
+        }
+
+        sprintf(msg, "%-12s max deviation multi/single field %e",
+                setups[is].label, maxdiff);
+        ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-MULTI");
+        if(maxdiff > atol) failed = 1;
+    }
+
+    free(ef);
+    free(ipds);
+    ommp_terminate(sys);
+
+    if(failed){
+        sprintf(msg, "Multiple and single field dipoles differ by more than %e", atol);
+        ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-MULTI");
+        return 1;
+    }
+
+    return 0;
+}
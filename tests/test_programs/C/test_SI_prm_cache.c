@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "openmmpol.h"
+
+// Quantities that only depend on the assigned parameters, used to check
+// that a system built from the cache is the same as the one built from
+// the prm file.
+typedef struct {
+    int mm_atoms, ld_cart;
+    double ebnd, evdw, eele, epol;
+    double *q;
+    int32_t *attype;
+} sys_snapshot;
+
+sys_snapshot load(const char *json){
+    OMMP_SYSTEM_PRT sys;
+    OMMP_QM_HELPER_PRT qmh;
+    sys_snapshot s;
+
+    ommp_smartinput(json, &sys, &qmh);
+    s.mm_atoms = ommp_get_mm_atoms(sys);
+    s.ld_cart = ommp_get_ld_cart(sys);
+    s.ebnd = ommp_get_full_bnd_energy(sys);
+    s.evdw = ommp_get_vdw_energy(sys);
+    s.eele = ommp_get_fixedelec_energy(sys);
+    s.epol = ommp_get_polelec_energy(sys);
+    s.q = (double *) malloc(sizeof(double) * s.ld_cart * s.mm_atoms);
+    memcpy(s.q, ommp_get_q(sys), sizeof(double) * s.ld_cart * s.mm_atoms);
+    s.attype = (int32_t *) malloc(sizeof(int32_t) * s.mm_atoms);
+    memcpy(s.attype, ommp_get_attypemm(sys), sizeof(int32_t) * s.mm_atoms);
+    ommp_terminate(sys);
+
+    return s;
+}
+
+int same_system(sys_snapshot *a, sys_snapshot *b, double atol){
+    if(a->mm_atoms != b->mm_atoms || a->ld_cart != b->ld_cart) return 0;
+    if(memcmp(a->q, b->q, sizeof(double) * a->ld_cart * a->mm_atoms)) return 0;
+    if(memcmp(a->attype, b->attype, sizeof(int32_t) * a->mm_atoms)) return 0;
+    return fabs(a->ebnd - b->ebnd) <= atol && fabs(a->evdw - b->evdw) <= atol &&
+           fabs(a->eele - b->eele) <= atol && fabs(a->epol - b->epol) <= atol;
+}
+
+void free_snapshot(sys_snapshot *s){
+    free(s->q);
+    free(s->attype);
+}
+
+// Number of cache files in dir, the name of the last one found is
+// copied in fname
+int find_cache_files(const char *dir, char *fname){
+    DIR *d = opendir(dir);
+    struct dirent *e;
+    int n = 0;
+
+    if(d == NULL) return 0;
+    while((e = readdir(d)) != NULL){
+        size_t l = strlen(e->d_name);
+        if(l > 8 && strcmp(e->d_name + l - 8, ".ommpprm") == 0){
+            sprintf(fname, "%s/%s", dir, e->d_name);
+            n++;
+        }
+    }
+    closedir(d);
+    return n;
+}
+
+char *read_file(const char *fname, long *size){
+    FILE *fp = fopen(fname, "rb");
+    char *buf;
+
+    *size = 0;
+    if(fp == NULL) return NULL;
+    fseek(fp, 0, SEEK_END);
+    *size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    buf = (char *) malloc(*size > 0 ? *size : 1);
+    if(fread(buf, 1, *size, fp) != (size_t) *size) *size = -1;
+    fclose(fp);
+    return buf;
+}
+
+ino_t file_inode(const char *fname){
+    struct stat st;
+
+    if(stat(fname, &st) != 0) return 0;
+    return st.st_ino;
+}
+
+int main(int argc, char **argv){
+    if(argc != 2 && argc != 3){
+        printf("Syntax expected\n");
+        printf("    $ test_SI_prm_cache.exe <JSON FILE> [<ABSOLUTE TOL>]\n");
+        return 1;
+    }
+
+    char msg[OMMP_STR_CHAR_MAX], cdir[] = "ommp_prm_cache_XXXXXX",
+         cfile[OMMP_STR_CHAR_MAX];
+    double atol = 1e-10;
+    int failed = 0;
+    long csize, size;
+    char *cbuf, *buf;
+    ino_t ino;
+    FILE *fp;
+    sys_snapshot ref, s;
+
+    if(argc == 3) atol = atof(argv[2]);
+
+    // Reference, without cache
+    ref = load(argv[1]);
+
+    if(mkdtemp(cdir) == NULL){
+        ommp_message("Unable to create cache directory", OMMP_VERBOSE_NONE, "TEST-CACHE");
+        return 1;
+    }
+    ommp_set_prm_cache_dir(cdir);
+
+    // 1. Miss: the prm file is parsed and the cache file is written
+    s = load(argv[1]);
+    if(find_cache_files(cdir, cfile) != 1){
+        ommp_message("Cache file not written", OMMP_VERBOSE_NONE, "TEST-CACHE");
+        rmdir(cdir);
+        return 1;
+    }
+    if(!same_system(&ref, &s, atol)){
+        ommp_message("Cache miss: system differs from reference", OMMP_VERBOSE_NONE, "TEST-CACHE");
+        failed = 1;
+    }
+    free_snapshot(&s);
+    cbuf = read_file(cfile, &csize);
+    ino = file_inode(cfile);
+
+    // 2. Hit: the cache file is read and not written again
+    s = load(argv[1]);
+    if(file_inode(cfile) != ino){
+        ommp_message("Cache hit: cache file rewritten", OMMP_VERBOSE_NONE, "TEST-CACHE");
+        failed = 1;
+    }
+    if(!same_system(&ref, &s, atol)){
+        ommp_message("Cache hit: system differs from reference", OMMP_VERBOSE_NONE, "TEST-CACHE");
+        failed = 1;
+    }
+    free_snapshot(&s);
+
+    // 3. Damaged cache files (truncated, or with invalid indices at the
+    //    end) should be discarded and written again
+    for(int i=0; i < 2; i++){
+        const char *label = (i == 0 ? "truncated" : "corrupted");
+
+        if(i == 0){
+            if(truncate(cfile, csize / 2) != 0) failed = 1;
+        }
+        else{
+            fp = fopen(cfile, "r+b");
+            if(fp != NULL){
+                fseek(fp, -64, SEEK_END);
+                for(int j=0; j < 64; j++) fputc(0xFF, fp);
+                fclose(fp);
+            }
+            else
+                failed = 1;
+        }
+        ino = file_inode(cfile);
+
+        s = load(argv[1]);
+        buf = read_file(cfile, &size);
+        if(file_inode(cfile) == ino || size != csize ||
+           buf == NULL || memcmp(buf, cbuf, csize)){
+            sprintf(msg, "Cache file %s: not rebuilt", label);
+            ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-CACHE");
+            failed = 1;
+        }
+        if(!same_system(&ref, &s, atol)){
+            sprintf(msg, "Cache file %s: system differs from reference", label);
+            ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-CACHE");
+            failed = 1;
+        }
+        free(buf);
+        free_snapshot(&s);
+    }
+
+    free(cbuf);
+    free_snapshot(&ref);
+    remove(cfile);
+    rmdir(cdir);
+
+    if(failed){
+        ommp_message("Parameter cache test failed", OMMP_VERBOSE_NONE, "TEST-CACHE");
+        return 1;
+    }
+    ommp_message("Cache miss, hit and rebuild of damaged files are correct",
+                 OMMP_VERBOSE_NONE, "TEST-CACHE");
+
+    return 0;
+}
@@ -0,0 +1,272 @@
+program bench_conn
+    !! Benchmark for the construction of the connectivity matrices of a
+    !! system from its adjacency matrix (eg. tests/1ao6/input.xyz or
+    !! tests/3kic/input.xyz with amoebabio18.prm). The 1-2 ... 1-5 atomic
+    !! connectivity and, for AMOEBA systems, the connectivity of the
+    !! polarization groups are built [nrep] times with the breadth-first
+    !! search of [[build_conn_upto_n]] and with the sparse matrix products
+    !! of [[build_conn_upto_n_mult]] (the previous implementation of the
+    !! library, defined below); the average times and the check that the
+    !! two implementations give the same matrices are reported.
+    use iso_c_binding, only: c_char
+    use omp_lib, only: omp_get_wtime
+    use ommp_interface
+    use mod_memory, only: ip, rp
+    use mod_adjacency_mat, only: yale_sparse, build_conn_upto_n, &
+                                 free_yale_sparse, copy_yale_sparse, &
+                                 reallocate_mat
+
+    implicit none
+
+    character(kind=c_char, len=120), dimension(3) :: args
+    integer :: narg, nrep
+    type(ommp_system), pointer :: my_system
+
+    narg = command_argument_count()
+    if (narg < 2 .or. narg > 3) then
+        write(6, *) "Syntax expected "
+        write(6, *) "   $ bench_conn.exe <XYZ FILE> <PRM FILE> &
+                    &[<N. OF REPETITIONS>]"
+        stop 1
+    end if
+
+    call get_command_argument(1, args(1))
+    call get_command_argument(2, args(2))
+    nrep = 10
+    if(narg == 3) then
+        call get_command_argument(3, args(3))
+        read(args(3), *) nrep
+    end if
+
+    call ommp_set_verbose(OMMP_VERBOSE_NONE)
+    call ommp_init_xyz(my_system, trim(args(1)), trim(args(2)))
+    write(6, '(A, I0)') "Atoms: ", my_system%top%mm_atoms
+
+    write(6, '(A12, 2A14, A12, A10)') "Matrices", "BFS (s)", &
+                                      "Products (s)", "Speedup", "Same"
+    call bench(my_system%top%conn(1), 4_ip, .false., "Atoms 1-5   ")
+    if(my_system%amoeba) &
+        call bench(my_system%eel%pg_conn(2), 3_ip, .true., "Pol. groups ")
+
+    call ommp_terminate(my_system)
+
+    contains
+
+    subroutine bench(adj, n, start_id, label)
+        type(yale_sparse), intent(in) :: adj
+        integer(ip), intent(in) :: n
+        logical, intent(in) :: start_id
+        character(len=12), intent(in) :: label
+
+        type(yale_sparse), allocatable :: res_bfs(:), res_mult(:)
+        real(rp) :: t0, t_bfs, t_mult, speedup
+        logical :: same
+        integer :: irep, i
+
+        t0 = omp_get_wtime()
+        do irep=1, nrep
+            if(allocated(res_bfs)) call free_conn(res_bfs)
+            call build_conn_upto_n(adj, n, res_bfs, start_id)
+        end do
+        t_bfs = (omp_get_wtime() - t0) / nrep
+
+        t0 = omp_get_wtime()
+        do irep=1, nrep
+            if(allocated(res_mult)) call free_conn(res_mult)
+            call build_conn_upto_n_mult(adj, n, res_mult, start_id)
+        end do
+        t_mult = (omp_get_wtime() - t0) / nrep
+
+        same = size(res_bfs) == size(res_mult)
+        do i=1, min(size(res_bfs), size(res_mult))
+            same = same .and. all(res_bfs(i)%ri == res_mult(i)%ri)
+            if(same) &
+                same = same .and. all(res_bfs(i)%ci(1:res_bfs(i)%ri(adj%n+1)-1) &
+                                      == res_mult(i)%ci(1:res_mult(i)%ri(adj%n+1)-1))
+        end do
+
+        speedup = 0.0
+        if(t_bfs > 0.0) speedup = t_mult / t_bfs
+        write(6, '(A12, 2F14.6, F12.2, L10)') label, t_bfs, t_mult, &
+                                              speedup, same
+
+        call free_conn(res_bfs)
+        call free_conn(res_mult)
+    end subroutine
+
+    subroutine free_conn(res)
+        type(yale_sparse), allocatable, intent(inout) :: res(:)
+        integer :: i
+
+        do i=1, size(res)
+            call free_yale_sparse(res(i))
+        end do
+        deallocate(res)
+    end subroutine
+
+    subroutine build_conn_upto_n_mult(adj, n, res, start_id)
+        !! Same as [[build_conn_upto_n]], but the connectivity matrices
+        !! are computed applying the recursive formula with sparse matrix
+        !! products, as it was done in the library before the breadth-first
+        !! search was introduced; it is used as reference.
+        implicit none
+
+        type(yale_sparse), intent(in) :: adj
+        !! Adjacency matrix in Yale format
+        integer(ip), intent(in) :: n
+        !! Maximum level of connectivity that should be computed
+        type(yale_sparse), intent(out), allocatable :: res(:)
+        !! Results connectivity matrices
+        logical :: start_id
+        !! Specifies if the first matrix allocated res(1) should be the 
+        !! identity (true) or the adjacency (false).
+
+        integer(ip) :: i, adj_idx
+        type(yale_sparse) :: tmp, id
+
+        if(start_id) then
+            allocate(res(n+1))
+            call sparse_identity(adj%n, res(1))
+            adj_idx = 2
+        else
+            allocate(res(n))
+            adj_idx = 1
+        end if
+        call copy_yale_sparse(adj, res(adj_idx))
+
+        do i=adj_idx+1, adj_idx+n-1
+            if(size(res(i-1)%ci) == 0) then
+                ! Create a null matrix
+                res(i)%n = res(i-1)%n
+                allocate(res(i)%ri(res(i)%n+1))
+                res(i)%ri = 1
+                allocate(res(i)%ci(0))
+            else
+                call mat_mult(res(i-1), res(adj_idx), res(i))
+                call mat_andnot(res(i), res(i-1), tmp)
+                if(i == adj_idx+1) then
+                    call sparse_identity(adj%n, id)
+                    call mat_andnot(tmp, id, res(i))
+                    if(start_id) then
+                        call copy_yale_sparse(id, res(1))
+                    end if
+                    call free_yale_sparse(id)
+                else
+                    call mat_andnot(tmp, res(i-2), res(i))
+                end if
+            end if
+        end do
+        call free_yale_sparse(tmp)
+    end subroutine build_conn_upto_n_mult
+
+    subroutine mat_mult(sp1, sp2, res)
+        !! Performs the operation \(res := sp1 \cdot sp2\) on boolean
+        !! sparse matrices; product correspond to logical and while sum
+        !! correspond to logical or.    
+        !! The product is performed exploiting the sparsity, and therefore
+        !! with a scaling \(\mathcal O(n)\).
+        implicit none
+
+        type(yale_sparse), intent(in) :: sp1, sp2
+        !! Input matrices (sparse boolean matrices in Yale format)
+        type(yale_sparse), intent(out) :: res
+        !! Output matrix (sparse boolean matrices in Yale format)
+
+        integer(ip) :: ic, ir, k, nnz, res_nnz
+
+        res%n = sp1%n
+        allocate(res%ri(res%n+1))
+
+        ! This is just a guess, it could be increased later
+        nnz = max(size(sp1%ci), size(sp2%ci))
+        res_nnz = nnz
+        allocate(res%ci(res_nnz))
+
+        res%ri(1) = 1
+        do ir = 1, sp1%n
+            res%ri(ir+1) = res%ri(ir)
+            do k = sp1%ri(ir), sp1%ri(ir+1) - 1
+                do ic = sp2%ri(sp1%ci(k)), sp2%ri(sp1%ci(k)+1)-1
+                    ! ir -> sp2%ci(ic)
+                     if(.not. any(res%ci(res%ri(ir):res%ri(ir+1)-1) == sp2%ci(ic))) then
+                         res%ci(res%ri(ir+1)) = sp2%ci(ic)
+                         res%ri(ir+1) = res%ri(ir+1) + 1
+
+                         if(res%ri(ir+1) > res_nnz) then
+                             res_nnz = res_nnz + nnz
+                             call reallocate_mat(res, res_nnz)
+                         endif
+                     end if
+                end do
+            end do
+        end do
+
+        ! Trim the output vector
+        nnz = res%ri(res%n+1) - 1
+        call reallocate_mat(res, nnz)    
+
+    end subroutine
+
+    subroutine mat_andnot(sp1, sp2, res)
+        !! Performs the operation \(res := sp1 \land \neg sp2\) on
+        !! boolean sparse matrices.
+
+        implicit none
+
+        type(yale_sparse), intent(in) :: sp1, sp2
+        !! Input matrices (sparse boolean matrices in Yale format)
+        type(yale_sparse), intent(out) :: res
+        !! Output matrix (sparse boolean matrices in Yale format)
+
+        integer(ip) :: ic, ir, ic2_1, ic2_2, nnz
+
+        res%n = sp1%n
+        allocate(res%ri(res%n+1))
+        !! Worst case scenario, nnz(res) will be nnz(sp1)
+        allocate(res%ci(sp1%ri(sp1%n+1))) 
+
+        res%ri(1) = 1
+        do ir = 1, sp1%n
+            res%ri(ir+1) = res%ri(ir)
+            do ic = sp1%ri(ir), sp1%ri(ir+1) - 1
+                ic2_1 = sp2%ri(ir)
+                ic2_2 = sp2%ri(ir+1) - 1
+                if(.not. any(sp2%ci(ic2_1:ic2_2) == sp1%ci(ic))) then
+                    res%ci(res%ri(ir+1)) = sp1%ci(ic)
+                    res%ri(ir+1) = res%ri(ir+1) + 1
+                end if
+            end do
+        end do
+
+        ! Trim the output vector
+        nnz = res%ri(res%n+1) - 1
+        call reallocate_mat(res, nnz)    
+
+    end subroutine
+
+    subroutine sparse_identity(n, res)
+        !! Create an identity matrix (boolean sparse, represented in
+        !! Yale format) of dimension \(n\).
+        implicit none
+
+        integer(ip), intent(in) :: n
+        !! Rank of the output matrix
+        type(yale_sparse), intent(out) :: res
+        !! Output matrix
+
+        integer(ip) :: i
+
+        res%n = n
+        allocate(res%ci(res%n))
+        allocate(res%ri(res%n+1))
+
+        !$omp parallel do
+        do i = 1, n
+            res%ci(i) = i
+            res%ri(i) = i
+        end do
+        res%ri(n+1) = n+1
+
+    end subroutine sparse_identity
+
+end program bench_conn
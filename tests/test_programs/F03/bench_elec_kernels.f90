@@ -0,0 +1,210 @@
+program bench_elec_kernels
+    !! Micro-benchmark for the kernels used in the direct calculation of
+    !! electrostatic properties. A random set of [ns] sources is generated
+    !! and the properties are computed at [nt] target points, both with the
+    !! scalar routines (one call to the Coulomb kernel and to the property
+    !! routines for each pair) and with the structure-of-arrays kernels of
+    !! [[mod_elec_kernels]]. For each order of the sources (charges or
+    !! multipoles up to quadrupoles) and each property (potential, field
+    !! and field gradient) the average time per target, the speedup and the
+    !! maximum deviation between the two implementations are reported; the
+    !! same is done for the field of two sets of point dipoles, also with
+    !! the damped kernels.
+    use iso_c_binding, only: c_char
+    use omp_lib, only: omp_get_wtime
+    use mod_memory, only: ip, rp
+    use mod_electrostatics, only: coulomb_kernel, q_elec_prop, &
+                                  mu_elec_prop, quad_elec_prop
+    use mod_elec_kernels
+
+    implicit none
+
+    character(kind=c_char, len=120), dimension(3) :: args
+    integer :: narg, nrep, irep
+    integer(ip) :: ns, nt, i, j, maxd, ncomp, k
+    real(rp), allocatable :: cs(:,:), ct(:,:), m(:,:), th(:)
+    real(rp), allocatable :: res_ref(:,:), res_soa(:,:), ef_soa(:,:,:)
+    real(rp) :: t0, t_ref, t_soa, kernel(5), dr(3), HE(10)
+    type(ommp_soa_sites) :: src
+
+    narg = command_argument_count()
+    if(narg > 3) then
+        write(6, *) "Syntax expected "
+        write(6, *) "   $ bench_elec_kernels.exe [<N. OF SOURCES>] &
+                    &[<N. OF TARGETS>] [<N. OF REPETITIONS>]"
+        stop 1
+    end if
+
+    ns = 5000
+    nt = 500
+    nrep = 5
+    if(narg >= 1) then
+        call get_command_argument(1, args(1))
+        read(args(1), *) ns
+    end if
+    if(narg >= 2) then
+        call get_command_argument(2, args(2))
+        read(args(2), *) nt
+    end if
+    if(narg >= 3) then
+        call get_command_argument(3, args(3))
+        read(args(3), *) nrep
+    end if
+
+    allocate(cs(3,ns), ct(3,nt), m(10,ns), th(ns))
+    allocate(res_ref(10,nt), res_soa(10,nt), ef_soa(3,2,nt))
+    call random_seed()
+    call random_number(cs)
+    call random_number(ct)
+    call random_number(m)
+    call random_number(th)
+    ! Sources in a box of 40 A^3 (in bohr), targets in its inner part
+    cs = cs * 75.0
+    ct = ct * 55.0 + 10.0
+    m = m - 0.5
+    th = th * 2.0 + 1.0
+
+    write(6, '(A, I0, A, I0, A)') "Sources: ", ns, ", targets: ", nt
+    write(6, '(A10, A6, 3A14, A12)') "Sources", "Der.", "Scalar (s)", &
+                                     "SoA (s)", "Speedup", "Max dev."
+
+    do ncomp=1, 10, 9
+        call soa_sites_init(src, ns, ncomp, cs, m(1:ncomp,:), th)
+        do maxd=0, 2
+            t0 = omp_get_wtime()
+            do irep=1, nrep
+                res_ref = 0.0
+                do i=1, nt
+                    do j=1, ns
+                        dr = ct(:,i) - cs(:,j)
+                        if(ncomp == 1) then
+                            call coulomb_kernel(dr, maxd, kernel)
+                            call q_elec_prop(m(1,j), dr, kernel, &
+                                             .true., res_ref(1,i), &
+                                             maxd > 0, res_ref(2:4,i), &
+                                             maxd > 1, res_ref(5:10,i), &
+                                             .false., HE)
+                        else
+                            call coulomb_kernel(dr, maxd+2, kernel)
+                            call q_elec_prop(m(1,j), dr, kernel, &
+                                             .true., res_ref(1,i), &
+                                             maxd > 0, res_ref(2:4,i), &
+                                             maxd > 1, res_ref(5:10,i), &
+                                             .false., HE)
+                            call mu_elec_prop(m(2:4,j), dr, kernel, &
+                                              .true., res_ref(1,i), &
+                                              maxd > 0, res_ref(2:4,i), &
+                                              maxd > 1, res_ref(5:10,i), &
+                                              .false., HE)
+                            call quad_elec_prop(m(5:10,j), dr, kernel, &
+                                                .true., res_ref(1,i), &
+                                                maxd > 0, res_ref(2:4,i), &
+                                                maxd > 1, res_ref(5:10,i), &
+                                                .false., HE)
+                        end if
+                    end do
+                end do
+            end do
+            t_ref = (omp_get_wtime() - t0) / nrep
+
+            t0 = omp_get_wtime()
+            do irep=1, nrep
+                res_soa = 0.0
+                do i=1, nt
+                    call soa_mpoles_prop(src, 1_ip, ns, ct(:,i), 0.0_rp, &
+                                         OMMP_SOA_DAMP_NONE, maxd, &
+                                         res_soa(1,i), res_soa(2:4,i), &
+                                         res_soa(5:10,i))
+                end do
+            end do
+            t_soa = (omp_get_wtime() - t0) / nrep
+
+            k = 1
+            if(maxd == 1) k = 4
+            if(maxd == 2) k = 10
+            call report(merge("Charges   ", "Multipoles", ncomp == 1), &
+                        maxd, t_ref, t_soa, &
+                        maxval(abs(res_ref(1:k,:) - res_soa(1:k,:))) / &
+                        maxval(abs(res_ref(1:k,:))))
+        end do
+        call soa_sites_terminate(src)
+    end do
+
+    ! Two sets of point dipoles, only the field is computed.
+    ! Note that the source order is the one used for the dipoles in
+    ! field_extD2D: (x1, y1, z1, x2, y2, z2) for each site, and the field
+    ! of the two sets is returned as a (3,2) array for each target.
+    call soa_sites_init(src, ns, 6_ip, cs, m(2:7,:), th)
+    t0 = omp_get_wtime()
+    do irep=1, nrep
+        res_ref = 0.0
+        do i=1, nt
+            do j=1, ns
+                dr = ct(:,i) - cs(:,j)
+                call coulomb_kernel(dr, 2_ip, kernel)
+                call mu_elec_prop(m(2:4,j), dr, kernel, &
+                                  .false., HE(1), .true., res_ref(2:4,i), &
+                                  .false., HE(1:6), .false., HE)
+                call mu_elec_prop(m(5:7,j), dr, kernel, &
+                                  .false., HE(1), .true., res_ref(5:7,i), &
+                                  .false., HE(1:6), .false., HE)
+            end do
+        end do
+    end do
+    t_ref = (omp_get_wtime() - t0) / nrep
+
+    t0 = omp_get_wtime()
+    do irep=1, nrep
+        ef_soa = 0.0
+        do i=1, nt
+            call soa_dipoles_field(src, 1_ip, ns, ct(:,i), 0.0_rp, &
+                                   OMMP_SOA_DAMP_NONE, 2_ip, ef_soa(:,:,i))
+        end do
+    end do
+    t_soa = (omp_get_wtime() - t0) / nrep
+    res_soa(2:7,:) = reshape(ef_soa, [6_ip, nt])
+    call report("Dipoles x2", 1_ip, t_ref, t_soa, &
+                maxval(abs(res_ref(2:7,:) - res_soa(2:7,:))) / &
+                maxval(abs(res_ref(2:7,:))))
+
+    ! Damped kernels have no scalar counterpart outside of the
+    ! electrostatics object, their cost is compared to the undamped one.
+    t_ref = t_soa
+    t0 = omp_get_wtime()
+    do irep=1, nrep
+        do i=1, nt
+            call soa_dipoles_field(src, 1_ip, ns, ct(:,i), 1.5_rp, &
+                                   OMMP_SOA_DAMP_AMOEBA, 2_ip, ef_soa(:,:,i))
+        end do
+    end do
+    t_soa = (omp_get_wtime() - t0) / nrep
+    call report("AMOEBA x2 ", 1_ip, t_ref, t_soa, 0.0_rp)
+
+    t0 = omp_get_wtime()
+    do irep=1, nrep
+        do i=1, nt
+            call soa_dipoles_field(src, 1_ip, ns, ct(:,i), 1.5_rp, &
+                                   OMMP_SOA_DAMP_WANG, 2_ip, ef_soa(:,:,i))
+        end do
+    end do
+    t_soa = (omp_get_wtime() - t0) / nrep
+    call report("Wang x2   ", 1_ip, t_ref, t_soa, 0.0_rp)
+    call soa_sites_terminate(src)
+
+    deallocate(cs, ct, m, th, res_ref, res_soa, ef_soa)
+
+    contains
+
+    subroutine report(label, maxd, t_ref, t_soa, dev)
+        character(len=10), intent(in) :: label
+        integer(ip), intent(in) :: maxd
+        real(rp), intent(in) :: t_ref, t_soa, dev
+        real(rp) :: speedup
+
+        speedup = 0.0
+        if(t_soa > 0.0) speedup = t_ref / t_soa
+        write(6, '(A10, I6, 2ES14.4, F14.2, ES12.2)') label, maxd, &
+            t_ref / nt, t_soa / nt, speedup, dev
+    end subroutine
+
+end program bench_elec_kernels
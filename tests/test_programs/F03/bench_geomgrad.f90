@@ -0,0 +1,199 @@
+program bench_geomgrad
+    !! Timings of the bonded and VdW gradients. For each number of threads
+    !! (1, 2, 4, ... up to the given maximum) the bonded and VdW 
+    !! geometrical gradients are computed [nrep] times with the library 
+    !! routines, that accumulate the contributions in thread-private 
+    !! buffers reduced at the end. Only the bond stretching gradient is 
+    !! also computed with a graph-coloured schedule, where terms are 
+    !! grouped so that no two terms of the same group share an atom and 
+    !! each group is computed in parallel without any synchronization.
+    !! Times are meaningful only if each thread runs on its own core.
+    use iso_c_binding, only: c_char
+    use omp_lib, only: omp_set_num_threads, omp_get_max_threads, &
+                       omp_get_wtime
+    use ommp_interface
+    use mod_bonded, only: bond_geomgrad
+    use mod_nonbonded, only: vdw_geomgrad
+    use mod_jacobian_mat, only: Rij_jacobian
+
+    implicit none
+
+    character(kind=c_char, len=120), dimension(3) :: args
+    integer :: narg, nrep, irep, nthr, maxthr, ncol
+    integer, allocatable :: col_ptr(:), col_bnd(:)
+    real(8) :: t0, t_bnd, t_vdw, t_bond, t_col
+    type(ommp_system), pointer :: my_system
+    type(ommp_qm_helper), pointer :: my_qmh
+    real(ommp_real), allocatable :: g(:,:), gcol(:,:)
+
+    narg = command_argument_count()
+    if (narg < 1 .or. narg > 3) then
+        write(6, *) "Syntax expected "
+        write(6, *) "   $ bench_geomgrad.exe <JSON FILE> [<N. OF REPETITIONS>] &
+                    &[<MAX N. OF THREADS>]"
+        stop 1
+    end if
+
+    call get_command_argument(1, args(1))
+    nrep = 10
+    if(narg >= 2) then
+        call get_command_argument(2, args(2))
+        read(args(2), *) nrep
+    end if
+    maxthr = omp_get_max_threads()
+    if(narg == 3) then
+        call get_command_argument(3, args(3))
+        read(args(3), *) maxthr
+    end if
+
+    call ommp_smartinput(trim(args(1)), my_system, my_qmh)
+    call ommp_set_verbose(OMMP_VERBOSE_NONE)
+    if(.not. my_system%use_bonded) then
+        write(6, *) "Bonded terms are required (eg. an input from .xyz/.prm)"
+        stop 1
+    end if
+
+    allocate(g(3, my_system%top%mm_atoms))
+    allocate(gcol(3, my_system%top%mm_atoms))
+
+    call color_bonds(my_system, ncol, col_ptr, col_bnd)
+    write(6, '(A, I0, A, I0, A)') "Bond terms: ", my_system%bds%nbond, &
+                                  " scheduled in ", ncol, " colours"
+
+    ! Warm-up and check of the coloured kernel against the library one
+    g = 0.0
+    call bond_geomgrad(my_system%bds, g)
+    gcol = 0.0
+    call bond_geomgrad_colored(my_system, ncol, col_ptr, col_bnd, gcol)
+    write(6, '(A, ES12.4)') "Max deviation coloured/buffered bond gradient: ", &
+                            maxval(abs(g-gcol))
+    if(my_system%use_nonbonded) call vdw_geomgrad(my_system%vdw, g)
+
+    write(6, '(A8, 4A18)') "Threads", "Bonded (buffers)", "VdW (buffers)", &
+                           "Bond (buffers)", "Bond (coloured)"
+    nthr = 1
+    do while(nthr <= maxthr)
+        call omp_set_num_threads(nthr)
+
+        t0 = omp_get_wtime()
+        do irep=1, nrep
+            call ommp_full_bnd_geomgrad(my_system, g)
+        end do
+        t_bnd = (omp_get_wtime() - t0) / nrep
+
+        t_vdw = 0.0
+        if(my_system%use_nonbonded) then
+            t0 = omp_get_wtime()
+            do irep=1, nrep
+                g = 0.0
+                call vdw_geomgrad(my_system%vdw, g)
+            end do
+            t_vdw = (omp_get_wtime() - t0) / nrep
+        end if
+
+        t0 = omp_get_wtime()
+        do irep=1, nrep
+            g = 0.0
+            call bond_geomgrad(my_system%bds, g)
+        end do
+        t_bond = (omp_get_wtime() - t0) / nrep
+
+        t0 = omp_get_wtime()
+        do irep=1, nrep
+            gcol = 0.0
+            call bond_geomgrad_colored(my_system, ncol, col_ptr, col_bnd, gcol)
+        end do
+        t_col = (omp_get_wtime() - t0) / nrep
+
+        write(6, '(I8, 4F18.6)') nthr, t_bnd, t_vdw, t_bond, t_col
+
+        nthr = nthr * 2
+    end do
+
+    deallocate(g, gcol, col_ptr, col_bnd)
+    if(associated(my_qmh)) call ommp_terminate_qm_helper(my_qmh)
+    if(associated(my_system)) call ommp_terminate(my_system)
+
+    contains
+
+    subroutine color_bonds(s, ncol, col_ptr, col_bnd)
+        !! Greedy colouring of bond terms: each bond gets the lowest colour
+        !! that is not already used by another bond on one of its atoms.
+        !! Bonds of colour ic are col_bnd(col_ptr(ic):col_ptr(ic+1)-1).
+        type(ommp_system), intent(in) :: s
+        integer, intent(out) :: ncol
+        integer, allocatable, intent(out) :: col_ptr(:), col_bnd(:)
+
+        integer, parameter :: maxcol = 64
+        logical, allocatable :: busy(:,:)
+        integer, allocatable :: bcol(:), pos(:)
+        integer :: i, ic, ia, ib
+
+        allocate(busy(maxcol, s%top%mm_atoms), bcol(s%bds%nbond))
+        busy = .false.
+        ncol = 0
+        do i=1, s%bds%nbond
+            ia = s%bds%bondat(1,i)
+            ib = s%bds%bondat(2,i)
+            do ic=1, maxcol
+                if(.not. (busy(ic,ia) .or. busy(ic,ib))) exit
+            end do
+            if(ic > maxcol) then
+                write(6, *) "Too many colours needed for bond terms"
+                stop 1
+            end if
+            busy(ic,ia) = .true.
+            busy(ic,ib) = .true.
+            bcol(i) = ic
+            ncol = max(ncol, ic)
+        end do
+
+        allocate(col_ptr(ncol+1), col_bnd(s%bds%nbond), pos(ncol))
+        col_ptr = 0
+        do i=1, s%bds%nbond
+            col_ptr(bcol(i)+1) = col_ptr(bcol(i)+1) + 1
+        end do
+        col_ptr(1) = 1
+        do ic=1, ncol
+            col_ptr(ic+1) = col_ptr(ic+1) + col_ptr(ic)
+        end do
+        pos = col_ptr(1:ncol)
+        do i=1, s%bds%nbond
+            col_bnd(pos(bcol(i))) = i
+            pos(bcol(i)) = pos(bcol(i)) + 1
+        end do
+
+        deallocate(busy, bcol, pos)
+    end subroutine
+
+    subroutine bond_geomgrad_colored(s, ncol, col_ptr, col_bnd, grad)
+        !! Same as bond_geomgrad (frozen atoms are not handled), but terms are
+        !! computed colour by colour, so that the gradient can be updated
+        !! directly without conflicts between threads.
+        type(ommp_system), intent(in) :: s
+        integer, intent(in) :: ncol, col_ptr(:), col_bnd(:)
+        real(ommp_real), intent(inout) :: grad(:,:)
+
+        integer :: ic, ii, i, ia, ib
+        real(ommp_real) :: l, dl, g, J_a(3), J_b(3)
+
+        do ic=1, ncol
+            !$omp parallel do default(shared) schedule(static) &
+            !$omp private(ii,i,ia,ib,l,dl,g,J_a,J_b)
+            do ii=col_ptr(ic), col_ptr(ic+1)-1
+                i = col_bnd(ii)
+                ia = s%bds%bondat(1,i)
+                ib = s%bds%bondat(2,i)
+
+                call Rij_jacobian(s%top%cmm(:,ia), s%top%cmm(:,ib), l, J_a, J_b)
+                dl = l - s%bds%l0bond(i)
+                g = 2 * s%bds%kbond(i) * dl * (1.0 + 3.0/2.0*s%bds%bond_cubic*dl &
+                                               + 2.0*s%bds%bond_quartic*dl**2)
+
+                grad(:,ia) = grad(:,ia) + J_a * g
+                grad(:,ib) = grad(:,ib) + J_b * g
+            end do
+        end do
+    end subroutine
+
+end program bench_geomgrad
@@ -0,0 +1,72 @@
+program bench_matvec
+    !! Benchmark for the matrix-vector product used in the iterative
+    !! solution of the polarization equations. The system is prepared
+    !! through a first (zero field) solution, then the dipole-dipole
+    !! field is computed [nrep] times for a trial set of dipoles and
+    !! the average time per matrix-vector product is reported.
+    use iso_c_binding, only: c_char
+    use ommp_interface
+    use mod_electrostatics, only: field_extD2D
+
+    implicit none
+
+    character(kind=c_char, len=120), dimension(2) :: args
+    integer :: narg, nrep, irep
+    integer(8) :: t0, t1, trate
+    type(ommp_system), pointer :: my_system
+    type(ommp_qm_helper), pointer :: my_qmh
+    real(ommp_real), allocatable :: ef(:,:), ipd(:,:), e(:,:)
+
+    narg = command_argument_count()
+    if (narg /= 2 .and. narg /= 1) then
+        write(6, *) "Syntax expected "
+        write(6, *) "   $ bench_matvec.exe <JSON FILE> [<N. OF MATVEC>]"
+        stop 1
+    end if
+
+    call get_command_argument(1, args(1))
+    nrep = 10
+    if(narg == 2) then
+        call get_command_argument(2, args(2))
+        read(args(2), *) nrep
+    end if
+
+    call ommp_smartinput(trim(args(1)), my_system, my_qmh)
+    call ommp_set_verbose(OMMP_VERBOSE_NONE)
+
+    allocate(ef(3, my_system%eel%pol_atoms))
+    allocate(ipd(3, my_system%eel%pol_atoms))
+    allocate(e(3, my_system%eel%pol_atoms))
+
+    ! Solve once to prepare screening lists and FMM structures
+    ef = 0.0
+    call system_clock(t0, trate)
+    call ommp_set_external_field(my_system, ef, OMMP_SOLVER_NONE, &
+                                  OMMP_MATV_NONE, .true.)
+    call system_clock(t1)
+    write(6, '(A, F12.4, A)') "First polarization solve: ", &
+                              real(t1-t0) / real(trate), " s"
+
+    ! Deterministic trial dipoles, so that checksums can be compared
+    do irep=1, my_system%eel%pol_atoms
+        ipd(:, irep) = [sin(real(3*irep, ommp_real)), &
+                        sin(real(3*irep+1, ommp_real)), &
+                        sin(real(3*irep+2, ommp_real))]
+    end do
+
+    call system_clock(t0)
+    do irep=1, nrep
+        e = 0.0
+        call field_extD2D(my_system%eel, ipd, e)
+    end do
+    call system_clock(t1)
+
+    write(6, '(A, I0, A, F12.4, A)') "Average time on ", nrep, &
+                                    " matrix-vector products: ", &
+                                    real(t1-t0) / real(trate) / nrep, " s"
+    write(6, '(A, ES20.12)') "Checksum: ", sum(abs(e))
+
+    deallocate(ef, ipd, e)
+    if(associated(my_qmh)) call ommp_terminate_qm_helper(my_qmh)
+    if(associated(my_system)) call ommp_terminate(my_system)
+end program bench_matvec
@@ -0,0 +1,122 @@
+program bench_prm_assign
+    !! Startup benchmark for the initialization of a system from Tinker xyz
+    !! and prm files (eg. tests/1ao6/input.xyz or tests/3kic/input.xyz with
+    !! amoebabio18.prm). The whole initialization is timed [nrep] times,
+    !! then the time spent reading the prm file and in each of the routines
+    !! of [[mod_prm]] that assign the force-field parameters to the system
+    !! is reported.
+    use iso_c_binding, only: c_char
+    use omp_lib, only: omp_get_wtime
+    use ommp_interface
+    use mod_nonbonded, only: vdw_terminate
+    use mod_bonded, only: bonded_terminate
+    use mod_prm, only: assign_pol, assign_mpoles, assign_vdw, assign_bond, &
+                       assign_angle, assign_urey, assign_strbnd, assign_opb, &
+                       assign_pitors, assign_torsion, assign_imptorsion, &
+                       assign_tortors, assign_angtor, assign_strtor, &
+                       ommp_prm_type, prm_load_file, prm_terminate
+
+    implicit none
+
+    integer, parameter :: nasg = 14
+    character(len=10), parameter :: asg_name(nasg) = &
+        ["pol       ", "mpoles    ", "vdw       ", "bond      ", &
+         "angle     ", "urey      ", "strbnd    ", "opb       ", &
+         "pitors    ", "torsion   ", "imptorsion", "tortors   ", &
+         "angtor    ", "strtor    "]
+    character(kind=c_char, len=120), dimension(3) :: args
+    type(ommp_prm_type) :: prm
+    integer :: narg, nrep, irep, i
+    real(8) :: t0, t_init, t_load, t_asg(nasg)
+    type(ommp_system), pointer :: my_system
+
+    narg = command_argument_count()
+    if (narg < 2 .or. narg > 3) then
+        write(6, *) "Syntax expected "
+        write(6, *) "   $ bench_prm_assign.exe <XYZ FILE> <PRM FILE> &
+                    &[<N. OF REPETITIONS>]"
+        stop 1
+    end if
+
+    call get_command_argument(1, args(1))
+    call get_command_argument(2, args(2))
+    nrep = 3
+    if(narg == 3) then
+        call get_command_argument(3, args(3))
+        read(args(3), *) nrep
+    end if
+
+    call ommp_set_verbose(OMMP_VERBOSE_NONE)
+
+    t0 = omp_get_wtime()
+    do irep=1, nrep
+        call ommp_init_xyz(my_system, trim(args(1)), trim(args(2)))
+        if(irep < nrep) call ommp_terminate(my_system)
+    end do
+    t_init = (omp_get_wtime() - t0) / nrep
+    write(6, '(A, I0)') "Atoms: ", my_system%top%mm_atoms
+    write(6, '(A, F12.4)') "Initialization from xyz/prm (s): ", t_init
+
+    ! Parameters are assigned again to the initialized system, as it is
+    ! done in mmpol_init_from_xyz, to time each routine separately.
+    t0 = omp_get_wtime()
+    do irep=1, nrep
+        call prm_load_file(prm, trim(args(2)))
+    end do
+    t_load = (omp_get_wtime() - t0) / nrep
+    write(6, '(A, F12.4)') "Reading of prm file (s): ", t_load
+
+    t_asg = 0.0
+    do irep=1, nrep
+        call vdw_terminate(my_system%vdw)
+        call bonded_terminate(my_system%bds)
+        deallocate(my_system%bds)
+        allocate(my_system%bds)
+        my_system%bds%top => my_system%top
+
+        do i=1, nasg
+            t0 = omp_get_wtime()
+            select case(i)
+                case(1)
+                    call assign_pol(my_system%eel, prm)
+                case(2)
+                    call assign_mpoles(my_system%eel, prm)
+                case(3)
+                    call assign_vdw(my_system%vdw, my_system%top, prm)
+                case(4)
+                    call assign_bond(my_system%bds, prm)
+                case(5)
+                    call assign_angle(my_system%bds, prm)
+                case(6)
+                    call assign_urey(my_system%bds, prm)
+                case(7)
+                    call assign_strbnd(my_system%bds, prm)
+                case(8)
+                    call assign_opb(my_system%bds, prm)
+                case(9)
+                    call assign_pitors(my_system%bds, prm)
+                case(10)
+                    call assign_torsion(my_system%bds, prm)
+                case(11)
+                    call assign_imptorsion(my_system%bds, prm)
+                case(12)
+                    call assign_tortors(my_system%bds, prm)
+                case(13)
+                    call assign_angtor(my_system%bds, prm)
+                case(14)
+                    call assign_strtor(my_system%bds, prm)
+            end select
+            t_asg(i) = t_asg(i) + (omp_get_wtime() - t0) / nrep
+        end do
+    end do
+
+    write(6, '(A12, A14)') "Parameters", "Time (s)"
+    do i=1, nasg
+        write(6, '(A12, F14.4)') asg_name(i), t_asg(i)
+    end do
+    write(6, '(A12, F14.4)') "Total", sum(t_asg)
+
+    call prm_terminate(prm)
+    call ommp_terminate(my_system)
+
+end program bench_prm_assign
@@ -0,0 +1,96 @@
+program bench_qm_helper
+    !! Strong-scaling benchmark for the electrostatic quantities between QM
+    !! nuclei and MM atoms computed by the QM helper (eg. on 1stm_qmtyr.json).
+    !! For each number of threads (1, 2, 4, ... up to the maximum available)
+    !! the field of nuclei at polarizable sites (energy preparation) and the
+    !! field, field gradients and Hessian of nuclei at MM sites together 
+    !! with the field of MM at nuclei (gradient preparation) are computed 
+    !! [nrep] times and the average timings are reported.
+    use iso_c_binding, only: c_char
+    use omp_lib, only: omp_set_num_threads, omp_get_max_threads, &
+                       omp_get_wtime
+    use ommp_interface
+
+    implicit none
+
+    character(kind=c_char, len=120), dimension(3) :: args
+    integer :: narg, nrep, irep, nthr, maxthr
+    real(8) :: t0, t_ene, t_grd, t_ref(2)
+    type(ommp_system), pointer :: my_system
+    type(ommp_qm_helper), pointer :: my_qmh
+
+    narg = command_argument_count()
+    if (narg < 1 .or. narg > 3) then
+        write(6, *) "Syntax expected "
+        write(6, *) "   $ bench_qm_helper.exe <JSON FILE> [<N. OF REPETITIONS>] &
+                    &[<MAX N. OF THREADS>]"
+        stop 1
+    end if
+
+    call get_command_argument(1, args(1))
+    nrep = 10
+    if(narg >= 2) then
+        call get_command_argument(2, args(2))
+        read(args(2), *) nrep
+    end if
+    maxthr = omp_get_max_threads()
+    if(narg == 3) then
+        call get_command_argument(3, args(3))
+        read(args(3), *) maxthr
+    end if
+
+    call ommp_smartinput(trim(args(1)), my_system, my_qmh)
+    call ommp_set_verbose(OMMP_VERBOSE_NONE)
+    if(.not. associated(my_qmh)) then
+        write(6, *) "Input file should contain a QM part"
+        stop 1
+    end if
+
+    ! Induced dipoles are needed for the field of MM at nuclei
+    call ommp_prepare_qm_ele_ene(my_system, my_qmh)
+    call ommp_set_external_field(my_system, my_qmh%E_n2p, OMMP_SOLVER_NONE, &
+                                 OMMP_MATV_NONE, .true.)
+    write(6, '(A, I0, A, I0, A)') "QM nuclei: ", my_qmh%qm_top%mm_atoms, &
+                                  " MM atoms: ", my_system%top%mm_atoms
+    
+    write(6, '(A8, 2A21)') "Threads", "Nuclei->Pol (ene)", "Nuclei<->MM (grd)"
+    nthr = 1
+    do while(nthr <= maxthr)
+        call omp_set_num_threads(nthr)
+
+        t0 = omp_get_wtime()
+        do irep=1, nrep
+            my_qmh%E_n2p_done = .false.
+            call ommp_prepare_qm_ele_ene(my_system, my_qmh)
+        end do
+        t_ene = (omp_get_wtime() - t0) / nrep
+
+        t0 = omp_get_wtime()
+        do irep=1, nrep
+            call ommp_prepare_qm_ele_grd(my_system, my_qmh)
+        end do
+        t_grd = (omp_get_wtime() - t0) / nrep
+
+        if(nthr == 1) t_ref = [t_ene, t_grd]
+        write(6, '(I8, 2(F12.6, " (x", F5.2, ")"))') nthr, &
+            t_ene, speedup(t_ref(1), t_ene), t_grd, speedup(t_ref(2), t_grd)
+
+        nthr = nthr * 2
+    end do
+    write(6, '(A, 4ES16.8)') "Checksums: ", sum(abs(my_qmh%E_n2p)), &
+        sum(abs(my_qmh%E_n2m)), sum(abs(my_qmh%G_n2m)), sum(abs(my_qmh%H_n2m))
+
+    call ommp_terminate_qm_helper(my_qmh)
+    call ommp_terminate(my_system)
+
+    contains
+
+    function speedup(tref, t)
+        real(8), intent(in) :: tref, t
+        real(8) :: speedup
+
+        speedup = 0.0
+        if(t > 0.0) speedup = tref / t
+    end function
+
+end program bench_qm_helper
@@ -0,0 +1,228 @@
+program test_SI_fmm_ext
+    !! Check of the FMM evaluation of potential and electric field of
+    !! static multipoles and induced dipoles at arbitrary external points.
+    !! A single set of more than OMMP_FMM_EXT_THR points is used, so that
+    !! FMM are used; half of the points are close to MM atoms, inside the
+    !! nodes of the tree, so that the local expansions are used, while the
+    !! other half lies outside the system, where only the multipolar
+    !! expansions are used. The reference is computed with the direct
+    !! path, splitting the points in blocks smaller than the threshold.
+    !! The tolerance is relative to the largest value of each property
+    !! and it is tied to the order of the expansions (fmm_maxl_static for
+    !! static multipoles, fmm_maxl_pol for induced dipoles); an additional
+    !! scale factor can be passed on command line.
+    use iso_c_binding, only: c_char
+    use ommp_interface
+    use mod_constants, only: angstrom2au, ommp_fmm_ext_thr, &
+                             ommp_fmm_ext_theta
+    use mod_electrostatics, only: potential_M2E, potential_D2E, &
+                                  field_M2E, field_D2E
+    use mod_fmm, only: fmm_tree_type, tree_far_is_separated
+
+    implicit none
+
+    character(kind=c_char, len=120), dimension(2) :: args
+    character(len=OMMP_STR_CHAR_MAX) :: msg
+    integer :: narg, i, n, n_local
+    type(ommp_system), pointer :: my_system
+    type(ommp_qm_helper), pointer :: my_qmh
+    real(ommp_real) :: scalf, ccenter(3), rmax, tol_static, tol_pol
+    real(ommp_real), allocatable :: c(:,:), ef(:,:), v(:), vref(:), &
+                                    e(:,:), eref(:,:)
+    logical :: failed = .false.
+
+    narg = command_argument_count()
+    if (narg /= 1 .and. narg /= 2) then
+        write(6, *) "Syntax expected "
+        write(6, *) "   $ test_SI_fmm_ext.exe <JSON FILE> [<TOL SCALE FACTOR>]"
+        call exit(1)
+    end if
+
+    call get_command_argument(1, args(1))
+    scalf = 1.0
+    if(narg == 2) then
+        call get_command_argument(2, args(2))
+        read(args(2), *) scalf
+    end if
+
+    call ommp_smartinput(trim(args(1)), my_system, my_qmh)
+    if(.not. my_system%eel%use_fmm) then
+        call ommp_message("FMM are not enabled for this system", &
+                          OMMP_VERBOSE_NONE, "TEST-FMM")
+        call exit(1)
+    end if
+
+    ! Induced dipoles in absence of external field
+    allocate(ef(3, my_system%eel%pol_atoms))
+    ef = 0.0
+    call ommp_set_external_field(my_system, ef, OMMP_SOLVER_NONE, OMMP_MATV_NONE)
+    deallocate(ef)
+
+    associate(eel => my_system%eel, cmm => my_system%top%cmm)
+        tol_static = scalf * ommp_fmm_ext_theta**(eel%fmm_maxl_static + 1)
+        tol_pol = scalf * ommp_fmm_ext_theta**(eel%fmm_maxl_pol + 1)
+
+        ! Points close to MM atoms (first half) and on a sphere enclosing
+        ! the whole system (second half)
+        n = 2 * ommp_fmm_ext_thr
+        allocate(c(3,n), v(n), vref(n), e(3,n), eref(3,n))
+        ccenter = sum(cmm, 2) / size(cmm, 2)
+        rmax = 0.0
+        do i=1, size(cmm, 2)
+            rmax = max(rmax, norm2(cmm(:,i) - ccenter))
+        end do
+        do i=1, n / 2
+            c(:,i) = cmm(:,mod(i-1, size(cmm, 2)) + 1) + 0.3 * angstrom2au * &
+                     direction(i)
+        end do
+        do i=n/2+1, n
+            c(:,i) = ccenter + (rmax + 3.0 * angstrom2au) * direction(i) &
+                     / norm2(direction(i))
+        end do
+
+        n_local = 0
+        do i=1, n
+            if(use_local(eel%tree, c(:,i), eel%fmm_distance)) n_local = n_local + 1
+        end do
+        write(msg, "(I0, A, I0, A)") n_local, " points out of ", n, &
+                                     " use local expansions"
+        call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-FMM")
+        if(n_local == 0) failed = .true.
+
+        v = 0.0
+        vref = 0.0
+        call potential_M2E(eel, c, v)
+        call blocks_potential(.false.)
+        call check_V("potential_M2E", tol_static)
+
+        v = 0.0
+        vref = 0.0
+        call potential_D2E(eel, c, v)
+        call blocks_potential(.true.)
+        call check_V("potential_D2E", tol_pol)
+
+        e = 0.0
+        eref = 0.0
+        call field_M2E(eel, c, e)
+        call blocks_field(.false.)
+        call check_E("field_M2E", tol_static)
+
+        e = 0.0
+        eref = 0.0
+        call field_D2E(eel, c, e)
+        call blocks_field(.true.)
+        call check_E("field_D2E", tol_pol)
+    end associate
+
+    deallocate(c, v, vref, e, eref)
+    call ommp_terminate(my_system)
+
+    if(failed) then
+        call ommp_message("FMM at external points differ from reference", &
+                          OMMP_VERBOSE_NONE, "TEST-FMM")
+        call exit(1)
+    end if
+
+    contains
+
+    function direction(i)
+        !! Pseudo-random vector used to place the i-th point
+        integer, intent(in) :: i
+        real(ommp_real) :: direction(3)
+
+        direction = [sin(real(i, ommp_real)), cos(2.0_ommp_real * i), &
+                     sin(3.0_ommp_real * i + 1)]
+    end function
+
+    subroutine blocks_potential(do_ipd)
+        !! Reference potential, from blocks of points below threshold
+        logical, intent(in) :: do_ipd
+
+        integer :: ib, nb
+
+        nb = ommp_fmm_ext_thr - 1
+        do ib=1, n, nb
+            if(do_ipd) then
+                call potential_D2E(my_system%eel, c(:,ib:min(n, ib+nb-1)), &
+                                   vref(ib:min(n, ib+nb-1)))
+            else
+                call potential_M2E(my_system%eel, c(:,ib:min(n, ib+nb-1)), &
+                                   vref(ib:min(n, ib+nb-1)))
+            end if
+        end do
+    end subroutine
+
+    subroutine blocks_field(do_ipd)
+        !! Reference field, from blocks of points below threshold
+        logical, intent(in) :: do_ipd
+
+        integer :: ib, nb
+
+        nb = ommp_fmm_ext_thr - 1
+        do ib=1, n, nb
+            if(do_ipd) then
+                call field_D2E(my_system%eel, c(:,ib:min(n, ib+nb-1)), &
+                               eref(:,ib:min(n, ib+nb-1)))
+            else
+                call field_M2E(my_system%eel, c(:,ib:min(n, ib+nb-1)), &
+                               eref(:,ib:min(n, ib+nb-1)))
+            end if
+        end do
+    end subroutine
+
+    subroutine check_V(label, tol)
+        character(len=*), intent(in) :: label
+        real(ommp_real), intent(in) :: tol
+
+        call report(label, maxval(abs(v - vref)), maxval(abs(vref)), tol)
+    end subroutine
+
+    subroutine check_E(label, tol)
+        character(len=*), intent(in) :: label
+        real(ommp_real), intent(in) :: tol
+
+        call report(label, maxval(abs(e - eref)), maxval(abs(eref)), tol)
+    end subroutine
+
+    subroutine report(label, maxdev, maxref, tol)
+        character(len=*), intent(in) :: label
+        real(ommp_real), intent(in) :: maxdev, maxref, tol
+
+        write(msg, "(A, A, ES12.4, A, ES12.4, A, ES12.4)") label, &
+            " max deviation ", maxdev, " max value ", maxref, &
+            " relative tolerance ", tol
+        call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-FMM")
+        if(maxdev > tol * maxref) failed = .true.
+    end subroutine
+
+    function use_local(t, c, dfar)
+        !! True if the far field at [c] is obtained from the local expansion
+        !! of a node of the tree (see [[cart_propfar_at_point]])
+        type(fmm_tree_type), intent(in) :: t
+        real(ommp_real), intent(in) :: c(3), dfar
+        logical :: use_local
+
+        integer :: i_node, j, j_node, i_loc
+
+        i_loc = 0
+        if(norm2(c - t%node_centroid(:,1)) <= t%node_dimension(1)) i_loc = 1
+        i_node = i_loc
+        do while(i_node /= 0)
+            j_node = 0
+            do j=1, t%tree_degree
+                if(t%children(j,i_node) == 0) cycle
+                if(norm2(c - t%node_centroid(:,t%children(j,i_node))) <= &
+                   t%node_dimension(t%children(j,i_node))) then
+                    j_node = t%children(j,i_node)
+                    exit
+                end if
+            end do
+            if(j_node /= 0) i_loc = j_node
+            i_node = j_node
+        end do
+
+        use_local = .false.
+        if(i_loc > 0) use_local = tree_far_is_separated(t, i_loc, c, dfar)
+    end function
+
+end program test_SI_fmm_ext
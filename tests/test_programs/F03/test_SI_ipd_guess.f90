@@ -0,0 +1,170 @@
+program test_SI_ipd_guess
+    !! Check of the extrapolation of the guess for the induced dipoles
+    !! after a change of coordinates. The json file should request a guess
+    !! method (ipd_guess and ipd_guess_history keys); the same system is
+    !! also loaded without guess and used as reference. Both systems are
+    !! moved along a short trajectory, and at each step the polarization
+    !! energy and the induced dipoles should match the reference within the
+    !! tolerance; once at least two solutions are stored, the extrapolated
+    !! guess should also be closer to the converged dipoles than the
+    !! solution at the previous geometry. It is also checked that the
+    !! history of solutions grows as expected and that it is cleared by
+    !! set_ipd_guess and by remove_null_pol.
+    use iso_c_binding, only: c_char
+    use ommp_interface
+    use mod_constants, only: angstrom2au
+    use mod_electrostatics, only: remove_null_pol
+
+    implicit none
+
+    character(kind=c_char, len=120), dimension(2) :: args
+    character(len=OMMP_STR_CHAR_MAX) :: msg
+    integer :: narg, i, istep, method, nhist
+    type(ommp_system), pointer :: my_system, ref_system
+    type(ommp_qm_helper), pointer :: my_qmh, ref_qmh
+    real(ommp_real) :: atol
+    real(ommp_real), allocatable :: c0(:,:), ipd_prev(:,:,:), guess(:,:,:)
+    logical :: failed = .false.
+
+    narg = command_argument_count()
+    if (narg /= 1 .and. narg /= 2) then
+        write(6, *) "Syntax expected "
+        write(6, *) "   $ test_SI_ipd_guess.exe <JSON FILE> [<ABSOLUTE TOL>]"
+        call exit(1)
+    end if
+
+    call get_command_argument(1, args(1))
+    atol = 1e-6
+    if(narg == 2) then
+        call get_command_argument(2, args(2))
+        read(args(2), *) atol
+    end if
+
+    call ommp_smartinput(trim(args(1)), my_system, my_qmh)
+    call ommp_smartinput(trim(args(1)), ref_system, ref_qmh)
+    call ommp_set_ipd_guess(ref_system, OMMP_IPD_GUESS_NONE, 1)
+
+    method = my_system%eel%ipd_guess_method
+    nhist = my_system%eel%ipd_guess_nhist
+    write(msg, "(A, I0, A, I0)") "Guess method ", method, &
+                                 " previous geometries ", nhist
+    call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-GUESS")
+    if(method == OMMP_IPD_GUESS_NONE) then
+        call ommp_message("No guess for induced dipoles is requested", &
+                          OMMP_VERBOSE_NONE, "TEST-GUESS")
+        call exit(1)
+    end if
+
+    allocate(c0(3, my_system%top%mm_atoms))
+    c0 = my_system%top%cmm
+
+    ! Solution at the starting geometry, so that it enters the history
+    call compare(0)
+    do istep=1, nhist + 2
+        ipd_prev = my_system%eel%ipd
+        call move(istep)
+        call check_hist(min(istep, nhist))
+        if(.not. my_system%eel%ipd_use_guess) then
+            call ommp_message("Guess not used after a change of coordinates", &
+                              OMMP_VERBOSE_NONE, "TEST-GUESS")
+            failed = .true.
+        end if
+        guess = my_system%eel%ipd
+        call compare(istep)
+        if(istep > 1) call check_guess()
+    end do
+
+    ! Changing the guess method clears the history
+    call ommp_set_ipd_guess(my_system, method, nhist)
+    call check_hist(0)
+    call move(nhist + 3)
+    call compare(nhist + 3)
+
+    ! Removing polarizable sites clears the history, since the stored
+    ! solutions refer to the old set of sites
+    call move(nhist + 4)
+    call compare(nhist + 4)
+    my_system%eel%pol(1) = 0.0
+    ref_system%eel%pol(1) = 0.0
+    call remove_null_pol(my_system%eel)
+    call remove_null_pol(ref_system%eel)
+    call check_hist(0)
+    call move(nhist + 5)
+    call compare(nhist + 5)
+    call move(nhist + 6)
+    call check_hist(1)
+    call compare(nhist + 6)
+
+    deallocate(c0, ipd_prev, guess)
+    call ommp_terminate(my_system)
+    call ommp_terminate(ref_system)
+
+    if(failed) then
+        call ommp_message("Induced dipoles with guess differ from reference", &
+                          OMMP_VERBOSE_NONE, "TEST-GUESS")
+        call exit(1)
+    end if
+
+    contains
+
+    subroutine move(istep)
+        !! Move both systems to the geometry of the istep-th step, along a
+        !! smooth trajectory where each atom oscillates around its position
+        integer, intent(in) :: istep
+
+        real(ommp_real), allocatable :: c(:,:)
+
+        allocate(c(3, size(c0, 2)))
+        do i=1, size(c0, 2)
+            c(:,i) = c0(:,i) + 0.05 * angstrom2au * sin(0.1 * istep) * &
+                     [sin(real(i, ommp_real)), cos(2.0_ommp_real * i), &
+                      sin(3.0_ommp_real * i + 1)]
+        end do
+        call ommp_update_coordinates(my_system, c)
+        call ommp_update_coordinates(ref_system, c)
+        deallocate(c)
+    end subroutine
+
+    subroutine check_hist(n)
+        !! Check the number of solutions stored in the history
+        integer, intent(in) :: n
+
+        if(my_system%eel%ipd_hist_n /= n) then
+            write(msg, "(A, I0, A, I0)") "Solutions in history ", &
+                my_system%eel%ipd_hist_n, " expected ", n
+            call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-GUESS")
+            failed = .true.
+        end if
+    end subroutine
+
+    subroutine check_guess()
+        !! Check that the extrapolated guess improves over the previous
+        !! solution
+        real(ommp_real) :: dev_guess, dev_prev
+
+        dev_guess = maxval(abs(guess - my_system%eel%ipd))
+        dev_prev = maxval(abs(ipd_prev - my_system%eel%ipd))
+        write(msg, "(A, ES12.4, A, ES12.4)") "Guess deviation ", dev_guess, &
+            " previous solution deviation ", dev_prev
+        call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-GUESS")
+        if(dev_guess > dev_prev) failed = .true.
+    end subroutine
+
+    subroutine compare(istep)
+        !! Compare polarization energy and induced dipoles with reference
+        integer, intent(in) :: istep
+
+        real(ommp_real) :: e, e_ref, maxdev
+
+        e = ommp_get_polelec_energy(my_system)
+        e_ref = ommp_get_polelec_energy(ref_system)
+        maxdev = maxval(abs(my_system%eel%ipd - ref_system%eel%ipd))
+
+        write(msg, "(A, I0, A, ES12.4, A, ES12.4)") "Step ", istep, &
+            " energy deviation ", abs(e - e_ref), &
+            " max dipole deviation ", maxdev
+        call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-GUESS")
+        if(abs(e - e_ref) > atol .or. maxdev > atol) failed = .true.
+    end subroutine
+
+end program test_SI_ipd_guess
@@ -0,0 +1,103 @@
+program test_SI_mmpol2ext_block
+    !! Check that ommp_potential_mmpol2ext_block can be called concurrently
+    !! from different OpenMP threads once the system has been prepared with
+    !! ommp_prepare_mmpol2ext. The potential of static and induced sites at
+    !! a set of points (enough to use FMM, when enabled, in a single call)
+    !! is computed by splitting the points in small blocks that are
+    !! distributed among the threads, and compared with the one computed by
+    !! ommp_potential_mmpol2ext on all the points at once. The calculation
+    !! is repeated a few times, to give races a chance to show up.
+    use iso_c_binding, only: c_char
+    use omp_lib, only: omp_get_thread_num
+    use ommp_interface
+    use mod_constants, only: angstrom2au, ommp_fmm_ext_thr
+
+    implicit none
+
+    integer, parameter :: nthreads = 4
+    !! Number of threads, fixed so that blocks are computed concurrently
+    !! also where a single thread would be used by default
+    integer, parameter :: block_size = 97
+    !! Size of the blocks, well below OMMP_FMM_EXT_THR
+    integer, parameter :: nrep = 3
+    !! Number of repetitions of the concurrent calculation
+
+    character(kind=c_char, len=120), dimension(2) :: args
+    character(len=OMMP_STR_CHAR_MAX) :: msg
+    integer :: narg, i, j, n, ib, irep
+    type(ommp_system), pointer :: my_system
+    type(ommp_qm_helper), pointer :: my_qmh
+    real(ommp_real) :: atol, maxdiff
+    real(ommp_real), allocatable :: ef(:,:), c(:,:), v(:), vref(:)
+    logical :: used_thread(0:nthreads-1)
+
+    narg = command_argument_count()
+    if (narg /= 1 .and. narg /= 2) then
+        write(6, *) "Syntax expected "
+        write(6, *) "   $ test_SI_mmpol2ext_block.exe <JSON FILE> [<ABSOLUTE TOL>]"
+        call exit(1)
+    end if
+
+    call get_command_argument(1, args(1))
+    atol = 1e-8
+    if(narg == 2) then
+        call get_command_argument(2, args(2))
+        read(args(2), *) atol
+    end if
+
+    call ommp_smartinput(trim(args(1)), my_system, my_qmh)
+
+    ! Induced dipoles in absence of external field
+    allocate(ef(3, my_system%eel%pol_atoms))
+    ef = 0.0
+    call ommp_set_external_field(my_system, ef, OMMP_SOLVER_NONE, OMMP_MATV_NONE)
+    deallocate(ef)
+
+    ! Points placed around the MM atoms
+    n = ommp_fmm_ext_thr + block_size
+    allocate(c(3,n), v(n), vref(n))
+    associate(cmm => my_system%top%cmm)
+        do i=1, n
+            j = mod(i-1, size(cmm, 2)) + 1
+            c(:,i) = cmm(:,j) + 2.0 * angstrom2au * &
+                     [sin(real(i, ommp_real)), cos(2.0_ommp_real * i), &
+                      sin(3.0_ommp_real * i + 1)]
+        end do
+    end associate
+
+    vref = 0.0
+    call ommp_potential_mmpol2ext(my_system, n, c, vref)
+
+    call ommp_prepare_mmpol2ext(my_system)
+    maxdiff = 0.0
+    used_thread = .false.
+    do irep=1, nrep
+        v = huge(1.0_ommp_real)
+        !$omp parallel do default(shared) num_threads(nthreads) &
+        !$omp schedule(dynamic) private(ib)
+        do ib=1, n, block_size
+            call ommp_potential_mmpol2ext_block(my_system, &
+                                                min(block_size, n-ib+1), &
+                                                c(:,ib:min(n, ib+block_size-1)), &
+                                                v(ib:min(n, ib+block_size-1)))
+            used_thread(omp_get_thread_num()) = .true.
+        end do
+        maxdiff = max(maxdiff, maxval(abs(v - vref)))
+    end do
+
+    write(msg, "(I0, A, L1, A, I0, A, ES12.4)") n, " points (FMM ", &
+        my_system%eel%use_fmm, ") on ", count(used_thread), &
+        " threads, max deviation block/full ", maxdiff
+    call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-EXT")
+
+    deallocate(c, v, vref)
+    call ommp_terminate(my_system)
+
+    if(maxdiff > atol) then
+        write(msg, "(A, ES12.4)") "Concurrent blocks and full potential &
+                                  &differ by more than ", atol
+        call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-EXT")
+        call exit(1)
+    end if
+
+end program test_SI_mmpol2ext_block
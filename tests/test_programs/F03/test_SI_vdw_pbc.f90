@@ -0,0 +1,295 @@
+program test_SI_vdw_pbc
+    !! Check of VdW energy and gradients with periodic boundary conditions.
+    !! The system is placed in a small orthorhombic and in a small triclinic
+    !! cell, just larger than the system itself, so that atoms close to the
+    !! faces interact with the periodic images of the atoms on the opposite
+    !! side; atoms are also moved to different images of the cell. Energy
+    !! and gradients computed by the library with neighbor lists (with and
+    !! without Verlet skin) are compared with a reference computed here
+    !! with a double loop over all pairs, where each pair interacts
+    !! through its true minimum image, searched among the 27 images
+    !! around the one given by rounding fractional coordinates.
+    use iso_c_binding, only: c_char
+    use ommp_interface
+    use mod_topology, only: cell_from_parameters
+    use mod_nonbonded, only: ommp_nonbonded_type
+    use mod_constants, only: angstrom2au, OMMP_VDWTYPE_LJ, &
+                             OMMP_RADRULE_ARITHMETIC, OMMP_RADRULE_CUBIC, &
+                             OMMP_EPSRULE_GEOMETRIC, OMMP_EPSRULE_HHG
+
+    implicit none
+
+    character(kind=c_char, len=120), dimension(2) :: args
+    character(len=OMMP_STR_CHAR_MAX) :: msg
+    integer :: narg, i, icell, iskin
+    type(ommp_system), pointer :: my_system
+    type(ommp_qm_helper), pointer :: my_qmh
+    real(ommp_real) :: atol, pad, lo(3), hi(3), cell(3,3), w(3), cutoff, &
+                       skin, ev, ev_ref, maxdg
+    real(ommp_real), allocatable :: c0(:,:), c(:,:), g(:,:), g_ref(:,:), &
+                                    scr(:,:)
+    logical :: failed = .false.
+
+    narg = command_argument_count()
+    if (narg /= 1 .and. narg /= 2) then
+        write(6, *) "Syntax expected "
+        write(6, *) "   $ test_SI_vdw_pbc.exe <JSON FILE> [<ABSOLUTE TOL>]"
+        call exit(1)
+    end if
+
+    call get_command_argument(1, args(1))
+    atol = 1e-8
+    if(narg == 2) then
+        call get_command_argument(2, args(2))
+        read(args(2), *) atol
+    end if
+
+    call ommp_smartinput(trim(args(1)), my_system, my_qmh)
+    if(.not. my_system%use_nonbonded) then
+        call ommp_message("VdW is not enabled for this system", &
+                          OMMP_VERBOSE_NONE, "TEST-VDW")
+        call exit(1)
+    end if
+
+    allocate(c0(3, my_system%top%mm_atoms), c(3, my_system%top%mm_atoms))
+    allocate(g(3, my_system%top%mm_atoms), g_ref(3, my_system%top%mm_atoms))
+    c0 = my_system%top%cmm
+    call screening_matrix(scr)
+
+    ! Cells are just larger than the system (the bounding box plus a gap)
+    pad = 2.5 * angstrom2au
+    lo = minval(c0, 2)
+    hi = maxval(c0, 2)
+
+    do icell=1, 2
+        if(icell == 1) then
+            cell = cell_from_parameters(hi - lo + pad, [90.0_ommp_real, 90.0_ommp_real, 90.0_ommp_real])
+        else
+            cell = cell_from_parameters(hi - lo + 4 * pad, [80.0_ommp_real, 100.0_ommp_real, 95.0_ommp_real])
+        end if
+        call ommp_set_pbc_box(my_system, cell)
+        w = cell_widths(cell)
+
+        ! Move each atom to a different periodic image
+        do i=1, my_system%top%mm_atoms
+            c(:,i) = c0(:,i) + matmul(cell, real([mod(i, 3) - 1, &
+                                                  mod(i / 3, 3) - 1, &
+                                                  mod(i / 9, 3) - 1], ommp_real))
+        end do
+        call ommp_update_coordinates(my_system, c)
+
+        do iskin=1, 2
+            skin = (iskin - 1) * angstrom2au
+            cutoff = min(9.0 * angstrom2au, 0.45 * minval(w) - skin)
+            call ommp_set_vdw_cutoff(my_system, cutoff)
+            call ommp_set_vdw_skin(my_system, skin)
+
+            ev = ommp_get_vdw_energy(my_system)
+            call ommp_vdw_geomgrad(my_system, g)
+            call reference(my_system, cell, cutoff, c, scr, ev_ref, g_ref)
+            maxdg = maxval(abs(g - g_ref))
+
+            write(msg, "(A, I0, A, F6.3, A, F6.3, A, ES20.12, A, ES20.12)") &
+                "Cell ", icell, " cutoff ", cutoff / angstrom2au, &
+                " skin ", skin / angstrom2au, " EV ", ev, " reference ", ev_ref
+            call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-VDW")
+            write(msg, "(A, ES12.4)") "Max deviation of gradients ", maxdg
+            call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-VDW")
+
+            if(abs(ev - ev_ref) > atol .or. maxdg > atol) failed = .true.
+        end do
+    end do
+
+    deallocate(c0, c, g, g_ref, scr)
+    call ommp_terminate(my_system)
+
+    if(failed) then
+        write(msg, "(A, ES12.4)") "VdW with PBC differs from reference by &
+                                  &more than ", atol
+        call ommp_message(msg, OMMP_VERBOSE_NONE, "TEST-VDW")
+        call exit(1)
+    end if
+
+    contains
+
+    function cell_widths(cell) result(w)
+        !! Distances between opposite faces of the cell
+        real(ommp_real), intent(in) :: cell(3,3)
+        real(ommp_real) :: w(3)
+
+        real(ommp_real) :: n(3)
+        integer :: k
+
+        do k=1, 3
+            n = cross(cell(:,mod(k, 3) + 1), cell(:,mod(k + 1, 3) + 1))
+            w(k) = abs(dot_product(cell(:,k), n)) / norm2(n)
+        end do
+    end function
+
+    function cross(a, b)
+        real(ommp_real), intent(in) :: a(3), b(3)
+        real(ommp_real) :: cross(3)
+
+        cross = [a(2)*b(3) - a(3)*b(2), a(3)*b(1) - a(1)*b(3), &
+                 a(1)*b(2) - a(2)*b(1)]
+    end function
+
+    function min_image(cell, dr) result(dmin)
+        !! True minimum image of distance vector dr
+        real(ommp_real), intent(in) :: cell(3,3), dr(3)
+        real(ommp_real) :: dmin(3)
+
+        real(ommp_real) :: rcell(3,3), f(3), d(3)
+        integer :: i, j, k
+
+        rcell = inverse3(cell)
+        f = matmul(rcell, dr)
+        f = f - anint(f)
+        dmin = matmul(cell, f)
+        do i=-1, 1
+            do j=-1, 1
+                do k=-1, 1
+                    d = matmul(cell, f + real([i, j, k], ommp_real))
+                    if(norm2(d) < norm2(dmin)) dmin = d
+                end do
+            end do
+        end do
+    end function
+
+    function inverse3(a) result(b)
+        real(ommp_real), intent(in) :: a(3,3)
+        real(ommp_real) :: b(3,3)
+
+        b(1,:) = cross(a(:,2), a(:,3))
+        b(2,:) = cross(a(:,3), a(:,1))
+        b(3,:) = cross(a(:,1), a(:,2))
+        b = b / dot_product(a(:,1), cross(a(:,2), a(:,3)))
+    end function
+
+    subroutine screening_matrix(scr)
+        !! Screening factor for each pair of atoms, from the connectivity
+        !! (1-2 ... 1-5 neighbours) of the topology
+        real(ommp_real), allocatable, intent(out) :: scr(:,:)
+
+        integer :: i, k, l
+
+        associate(top => my_system%top, vdw => my_system%vdw)
+            allocate(scr(top%mm_atoms, top%mm_atoms))
+            scr = 1.0
+            do k=min(size(top%conn), 4), 1, -1
+                do i=1, top%mm_atoms
+                    do l=top%conn(k)%ri(i), top%conn(k)%ri(i+1)-1
+                        scr(i, top%conn(k)%ci(l)) = vdw%vdw_screening(k)
+                    end do
+                end do
+            end do
+        end associate
+    end subroutine
+
+    subroutine reference(s, cell, cutoff, c, scr, ev, g)
+        !! VdW energy and gradients from a double loop over all pairs
+        type(ommp_system), intent(in) :: s
+        real(ommp_real), intent(in) :: cell(3,3), cutoff, c(:,:), scr(:,:)
+        real(ommp_real), intent(out) :: ev, g(:,:)
+
+        ! Same (single precision) constants used by the library
+        real(ommp_real), parameter :: delta = 0.07, gam = 0.12
+        integer :: i, j, l, ineigh(2), n
+        real(ommp_real) :: cc(3,2), f(2), dr(3), r, r0, e, rho, vp, dvdr, t1, t2
+
+        n = s%top%mm_atoms
+        ev = 0.0
+        g = 0.0
+        associate(vdw => s%vdw, top => s%top)
+            do i=1, n
+                do j=i+1, n
+                    if(scr(i,j) < 1e-10) cycle
+                    dr = min_image(cell, c(:,i) - c(:,j))
+                    if(norm2(dr) >= cutoff) cycle
+
+                    ! Interaction centers, displaced for monovalent atoms
+                    ineigh = [i, j]
+                    do l=1, 2
+                        f(l) = vdw%vdw_f(ineigh(l))
+                        cc(:,l) = c(:,ineigh(l))
+                        if(abs(f(l) - 1.0) > 1e-10) then
+                            ineigh(l) = top%conn(1)%ci(top%conn(1)%ri(ineigh(l)))
+                            cc(:,l) = c(:,ineigh(l)) + f(l) * &
+                                      min_image(cell, cc(:,l) - c(:,ineigh(l)))
+                        end if
+                    end do
+
+                    call pair_parameters(vdw, i, j, r0, e)
+                    if(r0 < 1e-10) cycle
+
+                    dr = min_image(cell, cc(:,1) - cc(:,2))
+                    r = norm2(dr)
+                    if(vdw%vdwtype == OMMP_VDWTYPE_LJ) then
+                        vp = e * ((r0/r)**12 - 2 * (r0/r)**6)
+                        dvdr = -12 * e * ((r0/r)**12 - (r0/r)**6) / r
+                    else
+                        rho = r / r0
+                        t1 = ((1 + delta) / (rho + delta))**7
+                        t2 = (1 + gam) / (rho**7 + gam) - 2
+                        vp = e * t1 * t2
+                        dvdr = e * (-7 * t1 / (rho + delta) * t2 - t1 * &
+                                    7 * (1 + gam) * rho**6 / (rho**7 + gam)**2) / r0
+                    end if
+                    ev = ev + scr(i,j) * vp
+
+                    ! Gradient on centers, projected on the atoms
+                    dr = scr(i,j) * dvdr * dr / r
+                    g(:,i) = g(:,i) + f(1) * dr
+                    g(:,ineigh(1)) = g(:,ineigh(1)) + (1 - f(1)) * dr
+                    g(:,j) = g(:,j) - f(2) * dr
+                    g(:,ineigh(2)) = g(:,ineigh(2)) - (1 - f(2)) * dr
+                end do
+            end do
+        end associate
+    end subroutine
+
+    subroutine pair_parameters(vdw, i, j, r0, e)
+        !! Equilibrium distance and energy for the pair i, j, from pair
+        !! specific parameters if available, from combination rules
+        !! otherwise
+        type(ommp_nonbonded_type), intent(in) :: vdw
+        integer, intent(in) :: i, j
+        real(ommp_real), intent(out) :: r0, e
+
+        integer :: l
+        real(ommp_real) :: ri, rj, ei, ej
+
+        do l=1, vdw%npair
+            if((vdw%vdw_pair_mask_a(i,l) .and. vdw%vdw_pair_mask_b(j,l)) .or. &
+               (vdw%vdw_pair_mask_a(j,l) .and. vdw%vdw_pair_mask_b(i,l))) then
+                r0 = vdw%vdw_pair_r(l)
+                e = vdw%vdw_pair_e(l)
+                return
+            end if
+        end do
+
+        ri = vdw%vdw_r(i)
+        rj = vdw%vdw_r(j)
+        ei = vdw%vdw_e(i)
+        ej = vdw%vdw_e(j)
+
+        r0 = 0.0
+        if(ri > 1e-10 .or. rj > 1e-10) then
+            if(vdw%radrule == OMMP_RADRULE_ARITHMETIC) then
+                r0 = vdw%radf * (ri + rj) / 2
+            else if(vdw%radrule == OMMP_RADRULE_CUBIC) then
+                r0 = (ri**3 + rj**3) / (ri**2 + rj**2)
+            end if
+        end if
+
+        e = 0.0
+        if(ei > 1e-10 .or. ej > 1e-10) then
+            if(vdw%epsrule == OMMP_EPSRULE_GEOMETRIC) then
+                e = sqrt(ei * ej)
+            else if(vdw%epsrule == OMMP_EPSRULE_HHG) then
+                e = 4 * ei * ej / (sqrt(ei) + sqrt(ej))**2
+            end if
+        end if
+    end subroutine
+
+end program test_SI_vdw_pbc